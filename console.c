@@ -178,6 +178,7 @@ static bool interpret_cmda(int argc, char *argv[])
     while (next_cmd && strcmp(argv[0], next_cmd->name) != 0)
         next_cmd = next_cmd->next;
     if (next_cmd) {
+        profile_command(next_cmd->name);
         ok = next_cmd->operation(argc, argv);
         if (!ok)
             record_error();
@@ -1,13 +1,17 @@
 /* Test support code */
 
+#include <sched.h>
 #include <setjmp.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "random.h"
 #include "report.h"
 
 /* Our program needs to use regular malloc/free */
@@ -22,6 +26,9 @@
 /* Value when deallocate block */
 #define MAGICFREE 0xffffffff
 
+/* Value when deallocate block without filling it */
+#define MAGICFREE_RAW 0xfffffffe
+
 /* Value at end of every block */
 #define MAGICFOOTER 0xbeefdead
 
@@ -30,34 +37,94 @@
 
 /* Data structures used by our code */
 
-/* Represent allocated blocks as doubly-linked list, with
- * next and prev pointers at beginning
+/* Allocated blocks are kept in tables, and each block remembers which table
+ * and which position there it occupies, so checking that a block is allocated
+ * takes constant time. free() may reuse the first words of a released block,
+ * which hold exactly these two fields, so when a block is freed again they
+ * are only trusted once the table is in range and its entry at the position
+ * is the block itself.
  */
 typedef struct __block_element {
-    struct __block_element *next, *prev;
+    size_t index;  /* Position in the table of allocated blocks */
+    size_t stripe; /* Which table */
     size_t payload_size;
     size_t magic_header; /* Marker to see if block seems legitimate */
     unsigned char payload[0];
     /* Also place magic number at tail of every block */
 } block_element_t;
 
-static block_element_t *allocated = NULL;
-static size_t allocated_count = 0;
+/* Each thread adds the blocks it allocates to a table of its own, as long as
+ * there are no more threads than tables. A block may be freed by any thread,
+ * so every table has its own lock, which is rarely contended. The lock holds
+ * the address of its owner's token, so that only the owner can release it.
+ *
+ * Freed blocks of up to CACHE_MAX bytes are kept in the table for reuse by
+ * later allocations of the same size class, which spares the round trip
+ * through free() and malloc() and the page faults of fresh memory, such as
+ * for the slabs of the queue code. A class hands out its oldest block only
+ * once it holds more than CACHE_HOLD of them, so a dangling pointer still
+ * finds its block marked as freed for a while. A reused block is checked
+ * for writes made after it was freed, and as its payload still holds the
+ * fill pattern, it is not filled again.
+ */
+#define N_STRIPES 16
+#define CACHE_MAX (256 * 1024)
+#define CACHE_DEPTH 128
+#define CACHE_HOLD 8
+#define CACHE_BYTES (16 * 1024 * 1024)
+
+/* 16-byte classes up to 512 bytes, then four classes per power of two */
+#define N_CLASSES 69
+
+struct block_cache {
+    block_element_t *ring[CACHE_DEPTH];
+    unsigned head, count;
+};
+
+struct block_table {
+    _Atomic(char *) owner;
+    block_element_t **blocks;
+    size_t count, cap;
+    struct block_cache cache[N_CLASSES];
+    size_t cached_bytes;
+};
+
+static struct block_table stripes[N_STRIPES];
+static atomic_uint next_stripe = 0;
+static _Thread_local int my_stripe = -1;
+
+/* Table the thread holds the lock of, released if an exception jumps out of
+ * it. It is recorded before locking and forgotten after unlocking, which is
+ * harmless because only the owner can release a lock.
+ */
+static _Thread_local char thread_token;
+static _Thread_local struct block_table *held_table = NULL;
 
 /* Percent probability of malloc failure */
 int fail_probability = 0;
 
+/* Seed of the generator deciding which allocations fail, 0 for a random one.
+ * Each thread runs its own generator, seeded again whenever the seed is set.
+ */
+int fail_seed = 0;
+static atomic_uint fail_seed_gen = 1;
+static _Thread_local unsigned fail_state_gen = 0;
+static _Thread_local uintptr_t fail_state;
+
+/* Whether to fill allocated and freed payloads with a pattern */
+int fill_blocks = 1;
+
 static bool cautious_mode = true;
 static bool noallocate_mode = false;
-static bool error_occurred = false;
-static char *error_message = "";
+static atomic_bool error_occurred = false;
 
 static int time_limit = 1;
 
-/* Data for managing exceptions */
-static jmp_buf env;
-static volatile sig_atomic_t jmp_ready = false;
-static bool time_limited = false;
+/* Data for managing exceptions, kept per thread */
+static _Thread_local char *error_message = "";
+static _Thread_local jmp_buf env;
+static _Thread_local volatile sig_atomic_t jmp_ready = false;
+static _Thread_local bool time_limited = false;
 
 /* For test_malloc and test_calloc */
 typedef enum {
@@ -67,17 +134,60 @@ typedef enum {
 
 /* Internal functions */
 
+static inline void lock_table(struct block_table *t)
+{
+    held_table = t;
+    char *free_lock = NULL;
+    while (!atomic_compare_exchange_weak(&t->owner, &free_lock,
+                                         &thread_token)) {
+        free_lock = NULL;
+        sched_yield();
+    }
+}
+
+static inline void unlock_table(struct block_table *t)
+{
+    char *self = &thread_token;
+    atomic_compare_exchange_strong(&t->owner, &self, NULL);
+    held_table = NULL;
+}
+
+/* Table new blocks of the calling thread go to */
+static struct block_table *own_table()
+{
+    if (my_stripe < 0)
+        my_stripe = atomic_fetch_add(&next_stripe, 1) % N_STRIPES;
+    return &stripes[my_stripe];
+}
+
 /* Should this allocation fail? */
 static bool fail_allocation()
 {
-    double weight = (double) random() / RAND_MAX;
-    return (weight < 0.01 * fail_probability);
+    if (fail_probability <= 0)
+        return false;
+
+    unsigned gen = atomic_load(&fail_seed_gen);
+    if (fail_state_gen != gen) {
+        fail_state_gen = gen;
+        if (fail_seed)
+            fail_state = random_shuffle(fail_seed) + (own_table() - stripes);
+        else
+            randombytes((uint8_t *) &fail_state, sizeof(fail_state));
+    }
+    return random_next(&fail_state) % 100 < (uintptr_t) fail_probability;
+}
+
+/* Whether @b is a block in @t, whose lock the caller holds */
+static bool is_allocated(struct block_table *t, block_element_t *b)
+{
+    return t && b->index < t->count && t->blocks[b->index] == b;
 }
 
-/* Find header of block, given its payload.
+/* Find header of block, given its payload, and lock the table it claims to
+ * be in, which is stored to @table (NULL if there is no such table).
  * Signal error if doesn't seem like legitimate block
  */
-static block_element_t *find_header(void *p)
+static block_element_t *find_header(void *p, struct block_table **table)
 {
     if (!p) {
         report_event(MSG_ERROR, "Attempting to free null block");
@@ -86,15 +196,14 @@ static block_element_t *find_header(void *p)
 
     block_element_t *b =
         (block_element_t *) ((size_t) p - sizeof(block_element_t));
+    struct block_table *t = b->stripe < N_STRIPES ? &stripes[b->stripe] : NULL;
+    if (t)
+        lock_table(t);
+    *table = t;
+
     if (cautious_mode) {
         /* Make sure this is really an allocated block */
-        block_element_t *ab = allocated;
-        bool found = false;
-        while (ab && !found) {
-            found = ab == b;
-            ab = ab->next;
-        }
-        if (!found) {
+        if (!is_allocated(t, b)) {
             report_event(MSG_ERROR,
                          "Attempted to free unallocated block.  Address = %p",
                          p);
@@ -113,6 +222,89 @@ static block_element_t *find_header(void *p)
     return b;
 }
 
+/* Whether all @n bytes at @p still hold the fill pattern */
+static bool is_filled(const unsigned char *p, size_t n)
+{
+    return !n || (p[0] == FILLCHAR && !memcmp(p, p + 1, n - 1));
+}
+
+/* Size class of a payload of @size bytes, or -1 if it is not cached */
+static int size_class(size_t size)
+{
+    if (size <= 512)
+        return (size + 15) / 16;
+    if (size > CACHE_MAX)
+        return -1;
+
+    int shift = 9;
+    while ((size - 1) >> (shift + 1))
+        shift++;
+    return 33 + (shift - 9) * 4 + (((size - 1) >> (shift - 2)) & 3);
+}
+
+/* Payload bytes every block of class @c has room for */
+static size_t class_size(int c)
+{
+    if (c <= 32)
+        return c * 16;
+    int shift = 9 + (c - 33) / 4;
+    return (size_t) (5 + (c - 33) % 4) << (shift - 2);
+}
+
+/* Take the oldest block of class @c from the cache of @t, if it may be
+ * reused already. Caller holds the lock of @t.
+ */
+static block_element_t *cache_take(struct block_table *t, int c)
+{
+    struct block_cache *cache = &t->cache[c];
+    if (cache->count <= CACHE_HOLD)
+        return NULL;
+
+    block_element_t *b = cache->ring[cache->head];
+    cache->head = (cache->head + 1) % CACHE_DEPTH;
+    cache->count--;
+    t->cached_bytes -= class_size(c);
+    return b;
+}
+
+/* Keep freed block @b in the cache of @t. Return false if it does not fit,
+ * in which case it goes back to free(). Caller holds the lock of @t.
+ */
+static bool cache_put(struct block_table *t, block_element_t *b)
+{
+    int c = size_class(b->payload_size);
+    if (c < 0)
+        return false;
+
+    struct block_cache *cache = &t->cache[c];
+    if (cache->count == CACHE_DEPTH ||
+        t->cached_bytes + class_size(c) > CACHE_BYTES)
+        return false;
+
+    cache->ring[(cache->head + cache->count) % CACHE_DEPTH] = b;
+    cache->count++;
+    t->cached_bytes += class_size(c);
+    return true;
+}
+
+/* Number of leading payload bytes of cached block @b which still hold the
+ * fill pattern, reporting a block written to after it was freed
+ */
+static size_t cached_fill(block_element_t *b)
+{
+    if (b->magic_header != MAGICFREE)
+        return 0;
+
+    if (!is_filled(b->payload, b->payload_size)) {
+        report_event(MSG_ERROR, "Block with address %p was modified after "
+                                "being freed",
+                     (void *) b->payload);
+        error_occurred = true;
+        return 0;
+    }
+    return b->payload_size;
+}
+
 /* Given pointer to block, find its footer */
 static size_t *find_footer(block_element_t *b)
 {
@@ -122,7 +314,8 @@ static size_t *find_footer(block_element_t *b)
     return p;
 }
 
-static void *alloc(alloc_t alloc_type, size_t size)
+/* Whether an allocation is disallowed or should fail, reporting why */
+static bool alloc_refused(alloc_t alloc_type)
 {
     if (noallocate_mode) {
         char *msg_alloc_forbidden[] = {
@@ -130,7 +323,7 @@ static void *alloc(alloc_t alloc_type, size_t size)
             "Calls to calloc are disallowed",
         };
         report_event(MSG_FATAL, "%s", msg_alloc_forbidden[alloc_type]);
-        return NULL;
+        return true;
     }
 
     if (fail_allocation()) {
@@ -139,14 +332,36 @@ static void *alloc(alloc_t alloc_type, size_t size)
             "Calloc returning NULL",
         };
         report_event(MSG_WARN, "%s", msg_alloc_failure[alloc_type]);
-        return NULL;
+        return true;
     }
+    return false;
+}
 
-    block_element_t *new_block =
-        malloc(size + sizeof(block_element_t) + sizeof(size_t));
-    if (!new_block) {
-        report_event(MSG_FATAL, "Couldn't allocate any more memory");
-        error_occurred = true;
+static void *alloc(alloc_t alloc_type, size_t size)
+{
+    if (alloc_refused(alloc_type))
+        return NULL;
+
+    struct timespec start;
+    if (mem_profile)
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct block_table *t = own_table();
+    lock_table(t);
+
+    /* A cached block of the same class has room for any size in it */
+    int c = size_class(size);
+    block_element_t *new_block = c >= 0 ? cache_take(t, c) : NULL;
+    size_t filled = 0;
+    if (new_block) {
+        filled = cached_fill(new_block);
+    } else {
+        new_block = malloc((c >= 0 ? class_size(c) : size) +
+                           sizeof(block_element_t) + sizeof(size_t));
+        if (!new_block) {
+            report_event(MSG_FATAL, "Couldn't allocate any more memory");
+            error_occurred = true;
+        }
     }
 
     // cppcheck-suppress nullPointerRedundantCheck
@@ -155,17 +370,34 @@ static void *alloc(alloc_t alloc_type, size_t size)
     new_block->payload_size = size;
     *find_footer(new_block) = MAGICFOOTER;
     void *p = (void *) &new_block->payload;
-    memset(p, !alloc_type * FILLCHAR, size);
-    // cppcheck-suppress nullPointerRedundantCheck
-    new_block->next = allocated;
+    if (alloc_type == TEST_CALLOC)
+        memset(p, 0, size);
+    else if (fill_blocks && filled < size)
+        memset(p + filled, FILLCHAR, size - filled);
+
+    if (t->count == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 1024;
+        block_element_t **blocks = realloc(t->blocks, cap * sizeof(*blocks));
+        if (!blocks) {
+            report_event(MSG_FATAL, "Couldn't allocate any more memory");
+            error_occurred = true;
+        }
+        t->blocks = blocks;
+        t->cap = cap;
+    }
     // cppcheck-suppress nullPointerRedundantCheck
-    new_block->prev = NULL;
-
-    if (allocated)
-        allocated->prev = new_block;
-    allocated = new_block;
-    allocated_count++;
-
+    new_block->stripe = t - stripes;
+    new_block->index = t->count;
+    t->blocks[t->count] = new_block;
+    t->count++;
+    unlock_table(t);
+
+    if (mem_profile) {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        profile_alloc(size, (end.tv_sec - start.tv_sec) * 1000000000L +
+                                (end.tv_nsec - start.tv_nsec));
+    }
     return p;
 }
 
@@ -176,6 +408,11 @@ void *test_malloc(size_t size)
     return alloc(TEST_MALLOC, size);
 }
 
+bool test_alloc_fails(void)
+{
+    return alloc_refused(TEST_MALLOC);
+}
+
 // cppcheck-suppress unusedFunction
 void *test_calloc(size_t nelem, size_t elsize)
 {
@@ -197,7 +434,15 @@ void test_free(void *p)
     if (!p)
         return;
 
-    block_element_t *b = find_header(p);
+    struct block_table *t;
+    block_element_t *b = find_header(p, &t);
+    /* Releasing a block which is not ours would only corrupt the heap */
+    if (cautious_mode && !is_allocated(t, b)) {
+        if (t)
+            unlock_table(t);
+        return;
+    }
+
     size_t footer = *find_footer(b);
     if (footer != MAGICFOOTER) {
         report_event(MSG_ERROR,
@@ -206,22 +451,26 @@ void test_free(void *p)
                      p);
         error_occurred = true;
     }
-    b->magic_header = MAGICFREE;
+    b->magic_header = fill_blocks ? MAGICFREE : MAGICFREE_RAW;
     *find_footer(b) = MAGICFREE;
-    memset(p, FILLCHAR, b->payload_size);
-
-    /* Unlink from list */
-    block_element_t *bn = b->next;
-    block_element_t *bp = b->prev;
-    if (bp)
-        bp->next = bn;
-    else
-        allocated = bn;
-    if (bn)
-        bn->prev = bp;
+    if (fill_blocks)
+        memset(p, FILLCHAR, b->payload_size);
+
+    /* Move the last block of the table into the freed position */
+    if (is_allocated(t, b)) {
+        block_element_t *last = t->blocks[--t->count];
+        last->index = b->index;
+        t->blocks[last->index] = last;
+        if (mem_profile)
+            profile_free(b->payload_size);
+
+        if (cache_put(t, b))
+            b = NULL;
+    }
+    if (t)
+        unlock_table(t);
 
     free(b);
-    allocated_count--;
 }
 
 // cppcheck-suppress unusedFunction
@@ -237,11 +486,23 @@ char *test_strdup(const char *s)
 
 size_t allocation_check()
 {
-    return allocated_count;
+    size_t count = 0;
+    for (int i = 0; i < N_STRIPES; i++) {
+        lock_table(&stripes[i]);
+        count += stripes[i].count;
+        unlock_table(&stripes[i]);
+    }
+    return count;
 }
 
 /* Implementation of functions for testing */
 
+/* Restart the generators of allocation failures from fail_seed */
+void reseed_failures(int oldval)
+{
+    atomic_fetch_add(&fail_seed_gen, 1);
+}
+
 /* Set/unset cautious mode.
  * In this mode, makes extra sure any block to be freed is currently allocated.
  */
@@ -261,19 +522,21 @@ void set_noallocate_mode(bool noallocate)
 /* Return whether any errors have occurred since last time set error limit */
 bool error_check()
 {
-    bool e = error_occurred;
-    error_occurred = false;
-    return e;
+    return atomic_exchange(&error_occurred, false);
 }
 
 /* Prepare for a risky operation using setjmp.
- * Function returns true for initial return, false for error return
+ * Function returns true for initial return, false for error return.
+ * The context belongs to the calling thread, which is also where a fault it
+ * causes is signalled.
  */
 bool exception_setup(bool limit_time)
 {
     if (sigsetjmp(env, 1)) {
         /* Got here from longjmp */
         jmp_ready = false;
+        if (held_table)
+            unlock_table(held_table);
         if (time_limited) {
             alarm(0);
             time_limited = false;
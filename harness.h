@@ -14,6 +14,11 @@ void *test_malloc(size_t size);
 void *test_calloc(size_t nmemb, size_t size);
 void test_free(void *p);
 char *test_strdup(const char *s);
+
+/* Whether an allocation served without malloc, such as a piece carved out of
+ * a larger block, should fail the way malloc would at this point
+ */
+bool test_alloc_fails(void);
 /* FIXME: provide test_realloc as well */
 
 #ifdef INTERNAL
@@ -24,6 +29,15 @@ size_t allocation_check();
 /* Probability of malloc failing, expressed as percent */
 extern int fail_probability;
 
+/* Seed of the allocation failures, 0 for a random one */
+extern int fail_seed;
+
+/* Restart allocation failures from fail_seed, as a setter of its option */
+void reseed_failures(int oldval);
+
+/* Whether to fill allocated and freed payloads with a pattern */
+extern int fill_blocks;
+
 /*
  * Set/unset cautious mode.
  * In this mode, makes extra sure any block to be freed is currently allocated.
@@ -40,7 +54,9 @@ void set_noallocate_mode(bool noallocate);
 bool error_check();
 
 /* Prepare for a risky operation using setjmp.
- * Function returns true for initial return, false for error return
+ * Function returns true for initial return, false for error return.
+ * Every thread has its own context, but the time limit relies on alarm(),
+ * so only one thread at a time should ask for it
  */
 bool exception_setup(bool limit_time);
 
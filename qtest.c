@@ -53,7 +53,6 @@ extern int show_entropy;
 
 /* How large is a queue before it's considered big.
  * This affects how it gets printed
- * and whether cautious mode is used when freeing the queue
  */
 #define BIG_LIST_SIZE 30
 
@@ -75,6 +74,32 @@ static int string_length = MAXSTRING;
 
 static int descend = 0;
 
+/* Hand inserted strings over to the queue instead of having them copied */
+static int own_strings = 0;
+
+/* Delete middle node through the positional index rather than walking */
+static int dm_index = 0;
+
+/* Order of values for sort, merge, ascend, descend and dedup */
+static int value_order = 0;
+
+static q_cmp_t order_cmp(void)
+{
+    static const q_cmp_t orders[] = {NULL, q_cmp_numeric, q_cmp_nocase,
+                                     q_cmp_length};
+    int n = sizeof(orders) / sizeof(orders[0]);
+    if (value_order <= 0 || value_order >= n)
+        return NULL;
+    return orders[value_order];
+}
+
+/* Compare two values in the order selected by the "order" option */
+static int value_cmp(const char *a, const char *b)
+{
+    q_cmp_t cmp = order_cmp();
+    return cmp ? cmp(a, b) : strcmp(a, b);
+}
+
 #define MIN_RANDSTR_LEN 5
 #define MAX_RANDSTR_LEN 10
 static const char charset[] = "abcdefghijklmnopqrstuvwxyz";
@@ -101,9 +126,6 @@ static bool do_free(int argc, char *argv[])
     }
     error_check();
 
-    if (current && current->size > BIG_LIST_SIZE)
-        set_cautious_mode(false);
-
     struct list_head *qnext = NULL;
     if (chain.size > 1) {
         qnext = (current->chain.next == &chain.head) ? chain.head.next
@@ -116,7 +138,6 @@ static bool do_free(int argc, char *argv[])
         if (exception_setup(true))
             q_free(current->q);
         exception_cancel();
-        set_cautious_mode(true);
     }
 
     if (current) {
@@ -180,6 +201,88 @@ static void fill_rand_string(char *buf, size_t buf_size)
     buf[len] = '\0';
 }
 
+/* Insert @reps copies of @inserts, or @reps random strings if @need_rand,
+ * through a single bulk insertion.
+ */
+static bool queue_insert_bulk(position_t pos,
+                              char *inserts,
+                              bool need_rand,
+                              int reps)
+{
+    const char **strs = NULL;
+    char *buf = NULL, *end = NULL;
+    if (need_rand) {
+        buf = malloc((size_t) reps * MAX_RANDSTR_LEN);
+        end = buf;
+        for (int r = 0; buf && r < reps; r++) {
+            fill_rand_string(end, MAX_RANDSTR_LEN);
+            end += strlen(end) + 1;
+        }
+    } else {
+        strs = malloc(sizeof(char *) * reps);
+        for (int r = 0; strs && r < reps; r++)
+            strs[r] = inserts;
+    }
+    if (!buf && !strs) {
+        report(1, "INTERNAL ERROR.  Could not allocate space for insertion");
+        return false;
+    }
+
+    bool ok = true, rval = false;
+    if (exception_setup(true)) {
+        if (need_rand)
+            rval = pos == POS_TAIL ? q_insert_tail_buf(current->q, buf, reps)
+                                   : q_insert_head_buf(current->q, buf, reps);
+        else
+            rval = pos == POS_TAIL ? q_insert_tail_bulk(current->q, strs, reps)
+                                   : q_insert_head_bulk(current->q, strs, reps);
+    }
+    exception_cancel();
+
+    if (rval) {
+        current->size += reps;
+        /* Look at the two elements inserted last */
+        q_iter_t it;
+        element_t *entry = pos == POS_TAIL ? q_iter_last(&it, current->q)
+                                           : q_iter_first(&it, current->q);
+        char *lasts = NULL;
+        for (int r = 0; ok && r < reps && r < 2; r++) {
+            char *cur_inserts = entry->value;
+            if (!cur_inserts) {
+                report(1, "ERROR: Failed to save copy of string in queue");
+                ok = false;
+            } else if (cur_inserts == inserts ||
+                       (cur_inserts >= buf && cur_inserts < end)) {
+                report(1,
+                       "ERROR: Need to allocate and copy string for new "
+                       "queue element");
+                ok = false;
+            } else if (r == 1 && lasts == cur_inserts && !intern_strings) {
+                report(1,
+                       "ERROR: Need to allocate separate string for each "
+                       "queue element");
+                ok = false;
+            }
+            lasts = cur_inserts;
+            entry = pos == POS_TAIL ? q_iter_prev(&it) : q_iter_next(&it);
+        }
+    } else {
+        fail_count++;
+        if (fail_count < fail_limit)
+            report(2, "Insertion of %d strings failed", reps);
+        else {
+            report(1,
+                   "ERROR: Insertion of %d strings failed (%d failures total)",
+                   reps, fail_count);
+            ok = false;
+        }
+    }
+
+    free(strs);
+    free(buf);
+    return ok && !error_check();
+}
+
 /* insertion */
 static bool queue_insert(position_t pos, int argc, char *argv[])
 {
@@ -226,29 +329,53 @@ static bool queue_insert(position_t pos, int argc, char *argv[])
                pos == POS_TAIL ? "tail" : "head");
     error_check();
 
+    /* A repeat count inserts the whole batch at once */
+    if (current && current->q && argc == 3 && reps > 0 && !own_strings) {
+        ok = queue_insert_bulk(pos, inserts, need_rand, reps);
+        q_show(3);
+        return ok;
+    }
+
     if (current && exception_setup(true)) {
         for (int r = 0; ok && r < reps; r++) {
             if (need_rand)
                 fill_rand_string(randstr_buf, sizeof(randstr_buf));
-            bool rval = pos == POS_TAIL ? q_insert_tail(current->q, inserts)
-                                        : q_insert_head(current->q, inserts);
+            char *owned = NULL;
+            bool rval;
+            if (own_strings) {
+                owned = test_strdup(inserts);
+                rval = owned && (pos == POS_TAIL
+                                     ? q_insert_tail_owned(current->q, owned)
+                                     : q_insert_head_owned(current->q, owned));
+                if (!rval)
+                    test_free(owned);
+            } else {
+                rval = pos == POS_TAIL ? q_insert_tail(current->q, inserts)
+                                       : q_insert_head(current->q, inserts);
+            }
             if (rval) {
                 current->size++;
-                element_t *entry =
-                    pos == POS_TAIL
-                        ? list_last_entry(current->q, element_t, list)
-                        : list_first_entry(current->q, element_t, list);
+                q_iter_t it;
+                element_t *entry = pos == POS_TAIL
+                                       ? q_iter_last(&it, current->q)
+                                       : q_iter_first(&it, current->q);
                 char *cur_inserts = entry->value;
                 if (!cur_inserts) {
                     report(1, "ERROR: Failed to save copy of string in queue");
                     ok = false;
+                } else if (owned && owned != cur_inserts) {
+                    report(1,
+                           "ERROR: String handed over to the queue was copied");
+                    ok = false;
+                    break;
                 } else if (r == 0 && inserts == cur_inserts) {
                     report(1,
                            "ERROR: Need to allocate and copy string for new "
                            "queue element");
                     ok = false;
                     break;
-                } else if (r == 1 && lasts == cur_inserts) {
+                } else if (r == 1 && lasts == cur_inserts &&
+                           !intern_strings) {
                     report(1,
                            "ERROR: Need to allocate separate string for each "
                            "queue element");
@@ -417,10 +544,52 @@ static inline bool do_rt(int argc, char *argv[])
     return queue_remove(POS_TAIL, argc, argv);
 }
 
+typedef struct {
+    const char *value;
+    int idx;
+} dup_item_t;
+
+static int dup_item_cmp(const void *a, const void *b)
+{
+    const dup_item_t *x = a, *y = b;
+    int cmp = strcmp(x->value, y->value);
+    return cmp ? cmp : x->idx - y->idx;
+}
+
+/* Flag, in queue order, the strings of @l occurring exactly once in it */
+static bool *unique_flags(struct list_head *l, int n)
+{
+    bool *unique = malloc(sizeof(bool) * (n ? n : 1));
+    dup_item_t *items = malloc(sizeof(dup_item_t) * (n ? n : 1));
+    if (!unique || !items) {
+        free(unique);
+        free(items);
+        return NULL;
+    }
+
+    element_t *item;
+    int i = 0;
+    list_for_each_entry (item, l, list) {
+        items[i].value = item->value;
+        items[i].idx = i;
+        i++;
+    }
+    qsort(items, n, sizeof(dup_item_t), dup_item_cmp);
+    for (i = 0; i < n; i++) {
+        unique[items[i].idx] =
+            (i == 0 || strcmp(items[i - 1].value, items[i].value)) &&
+            (i == n - 1 || strcmp(items[i + 1].value, items[i].value));
+    }
+
+    free(items);
+    return unique;
+}
+
 static bool do_dedup(int argc, char *argv[])
 {
-    if (argc != 1) {
-        report(1, "%s takes no arguments", argv[0]);
+    bool hash = argc == 2 && !strcmp(argv[1], "hash");
+    if (argc != 1 && !hash) {
+        report(1, "%s takes no arguments other than 'hash'", argv[0]);
         return false;
     }
 
@@ -431,10 +600,11 @@ static bool do_dedup(int argc, char *argv[])
 
     LIST_HEAD(l_copy);
     element_t *item = NULL, *tmp = NULL;
+    q_iter_t it;
 
     // Copy current->q to l_copy
     if (current->q && !list_empty(current->q)) {
-        list_for_each_entry (item, current->q, list) {
+        q_for_each (item, it, current->q) {
             size_t slen;
             tmp = malloc(sizeof(element_t));
             if (!tmp)
@@ -450,7 +620,22 @@ static bool do_dedup(int argc, char *argv[])
             list_add_tail(&tmp->list, &l_copy);
         }
         // Return false if the loop does not leave properly
-        if (&item->list != current->q) {
+        if (item) {
+            list_for_each_entry_safe (item, tmp, &l_copy, list) {
+                free(item->value);
+                free(item);
+            }
+            report(1,
+                   "INTERNAL ERROR.  Could not allocate space for "
+                   "duplicate checking");
+            return false;
+        }
+    }
+
+    bool *unique = NULL;
+    if (hash) {
+        unique = unique_flags(&l_copy, current->size);
+        if (!unique) {
             list_for_each_entry_safe (item, tmp, &l_copy, list) {
                 free(item->value);
                 free(item);
@@ -464,7 +649,8 @@ static bool do_dedup(int argc, char *argv[])
 
     bool ok = true;
     if (exception_setup(true))
-        ok = q_delete_dup(current->q);
+        ok = hash ? q_delete_dup_hash(current->q)
+                  : q_delete_dup_cmp(current->q, order_cmp());
     exception_cancel();
 
     if (!ok) {
@@ -472,32 +658,45 @@ static bool do_dedup(int argc, char *argv[])
             free(item->value);
             free(item);
         }
-        report(1, "ERROR: Calling delete duplicate on null queue");
-        return false;
+        free(unique);
+        if (!hash || !current->size) {
+            report(1, "ERROR: Calling delete duplicate on null queue");
+            return false;
+        }
+        /* The hash table could not be allocated, which is allowed to fail */
+        fail_count++;
+        if (fail_count < fail_limit)
+            report(2, "Deleting duplicates failed");
+        else {
+            report(1, "ERROR: Deleting duplicates failed (%d failures total)",
+                   fail_count);
+            return false;
+        }
+        return !error_check();
     }
 
-    struct list_head *l_tmp = current->q->next;
+    element_t *kept = q_iter_first(&it, current->q);
     bool is_this_dup = false;
+    int idx = 0;
     // Compare between new list and old one
     list_for_each_entry (item, &l_copy, list) {
         // Skip comparison with new list if the string is duplicate
         bool is_next_dup =
             item->list.next != &l_copy &&
-            strcmp(list_entry(item->list.next, element_t, list)->value,
-                   item->value) == 0;
-        if (is_this_dup || is_next_dup) {
+            (hash ? strcmp : value_cmp)(
+                list_entry(item->list.next, element_t, list)->value,
+                item->value) == 0;
+        if (hash ? !unique[idx++] : is_this_dup || is_next_dup) {
             // Update list size
             current->size--;
-        } else if (l_tmp != current->q &&
-                   strcmp(list_entry(l_tmp, element_t, list)->value,
-                          item->value) == 0)
-            l_tmp = l_tmp->next;
+        } else if (kept && strcmp(kept->value, item->value) == 0)
+            kept = q_iter_next(&it);
         else
             ok = false;
         is_this_dup = is_next_dup;
     }
     // All elements in new list should be traversed
-    ok = ok && l_tmp == current->q;
+    ok = ok && !kept;
     if (!ok)
         report(1,
                "ERROR: Duplicate strings are in queue or distinct strings are "
@@ -507,6 +706,7 @@ static bool do_dedup(int argc, char *argv[])
         free(item->value);
         free(item);
     }
+    free(unique);
 
     q_show(3);
     return ok && !error_check();
@@ -576,6 +776,51 @@ static bool do_size(int argc, char *argv[])
     return ok && !error_check();
 }
 
+/* Position of each element before sorting, kept in an open addressing table
+ * keyed by element address, so stability is checked in one linear pass.
+ */
+struct ordinal_map {
+    struct {
+        const element_t *e;
+        size_t ord;
+    } *slots;
+    size_t mask;
+};
+
+static bool ordinal_map_init(struct ordinal_map *m, size_t n)
+{
+    size_t cap = 16;
+    while (cap < n + n / 2)
+        cap <<= 1;
+    m->slots = calloc(cap, sizeof(*m->slots));
+    m->mask = cap - 1;
+    return m->slots;
+}
+
+static size_t ordinal_map_find(const struct ordinal_map *m, const element_t *e)
+{
+    /* Elements mostly lie in memory in the order they were inserted, so
+     * plain address bits keep lookups of an equal run close together.
+     */
+    size_t i = ((uintptr_t) e >> 4) & m->mask;
+    while (m->slots[i].e && m->slots[i].e != e)
+        i = (i + 1) & m->mask;
+    return i;
+}
+
+static void ordinal_map_put(struct ordinal_map *m, const element_t *e,
+                            size_t ord)
+{
+    size_t i = ordinal_map_find(m, e);
+    m->slots[i].e = e;
+    m->slots[i].ord = ord;
+}
+
+static size_t ordinal_map_get(const struct ordinal_map *m, const element_t *e)
+{
+    return m->slots[ordinal_map_find(m, e)].ord;
+}
+
 bool do_sort(int argc, char *argv[])
 {
     if (argc != 1) {
@@ -596,72 +841,55 @@ bool do_sort(int argc, char *argv[])
 
     set_noallocate_mode(true);
 
-/* If the number of elements is too large, it may take a long time to check the
- * stability of the sort. So, MAX_NODES is used to limit the number of elements
- * to check the stability of the sort. */
-#define MAX_NODES 100000
-    struct list_head *nodes[MAX_NODES];
-    unsigned no = 0;
-    if (current && current->size && current->size <= MAX_NODES) {
+    struct ordinal_map ords = {0};
+    q_iter_t it;
+    if (current && current->size && ordinal_map_init(&ords, current->size)) {
         element_t *entry;
-        list_for_each_entry (entry, current->q, list)
-            nodes[no++] = &entry->list;
-    } else if (current && current->size > MAX_NODES)
+        size_t no = 0;
+        q_for_each (entry, it, current->q)
+            ordinal_map_put(&ords, entry, no++);
+    } else if (current && current->size)
         report(1,
-               "Warning: Skip checking the stability of the sort because the "
-               "number of elements %d is too large, exceeds the limit %d.",
-               current->size, MAX_NODES);
+               "Warning: Skip checking the stability of the sort because "
+               "there is no memory to record the order of %d elements.",
+               current->size);
 
     if (current && exception_setup(true))
-        q_sort(current->q, descend);
+        q_sort_cmp(current->q, order_cmp(), descend);
     exception_cancel();
     set_noallocate_mode(false);
 
     bool ok = true;
     if (current && current->size) {
-        for (struct list_head *cur_l = current->q->next;
-             cur_l != current->q && --cnt; cur_l = cur_l->next) {
+        element_t *item, *next_item;
+        for (item = q_iter_first(&it, current->q);
+             --cnt && (next_item = q_iter_next(&it)); item = next_item) {
             /* Ensure each element in ascending/descending order */
-            element_t *item, *next_item;
-            item = list_entry(cur_l, element_t, list);
-            next_item = list_entry(cur_l->next, element_t, list);
-            if (!descend && strcmp(item->value, next_item->value) > 0) {
+            if (!descend && value_cmp(item->value, next_item->value) > 0) {
                 report(1, "ERROR: Not sorted in ascending order");
                 ok = false;
                 break;
             }
 
-            if (descend && strcmp(item->value, next_item->value) < 0) {
+            if (descend && value_cmp(item->value, next_item->value) < 0) {
                 report(1, "ERROR: Not sorted in descending order");
                 ok = false;
                 break;
             }
             /* Ensure the stability of the sort */
-            if (current->size <= MAX_NODES &&
-                !strcmp(item->value, next_item->value)) {
-                bool unstable = false;
-                for (unsigned i = 0; i < MAX_NODES; i++) {
-                    if (nodes[i] == cur_l->next) {
-                        unstable = true;
-                        break;
-                    }
-                    if (nodes[i] == cur_l) {
-                        break;
-                    }
-                }
-                if (unstable) {
-                    report(
-                        1,
-                        "ERROR: Not stable sort. The duplicate strings \"%s\" "
-                        "are not in the same order.",
-                        item->value);
-                    ok = false;
-                    break;
-                }
+            if (ords.slots && !value_cmp(item->value, next_item->value) &&
+                ordinal_map_get(&ords, item) >
+                    ordinal_map_get(&ords, next_item)) {
+                report(1,
+                       "ERROR: Not stable sort. The duplicate strings \"%s\" "
+                       "are not in the same order.",
+                       item->value);
+                ok = false;
+                break;
             }
         }
     }
-#undef MAX_NODES
+    free(ords.slots);
 
     q_show(3);
     return ok && !error_check();
@@ -669,8 +897,14 @@ bool do_sort(int argc, char *argv[])
 
 static bool do_dm(int argc, char *argv[])
 {
-    if (argc != 1) {
-        report(1, "%s takes no arguments", argv[0]);
+    if (argc != 1 && argc != 2) {
+        report(1, "%s takes 0-1 arguments", argv[0]);
+        return false;
+    }
+
+    int reps = 1;
+    if (argc == 2 && !get_int(argv[1], &reps)) {
+        report(1, "Invalid number of calls to dm '%s'", argv[1]);
         return false;
     }
 
@@ -681,14 +915,160 @@ static bool do_dm(int argc, char *argv[])
     error_check();
 
     bool ok = true;
-    if (exception_setup(true))
-        ok = q_delete_mid(current->q);
+    if (exception_setup(true)) {
+        for (int r = 0; ok && r < reps; r++) {
+            ok = dm_index ? q_delete_mid_index(current->q)
+                          : q_delete_mid(current->q);
+            if (!current->size)
+                report(3, "Warning: Try to delete middle node to empty queue");
+            else
+                --current->size;
+            ok = ok && !error_check();
+        }
+    }
+    exception_cancel();
+
+    q_show(3);
+    return ok && !error_check();
+}
+
+/* Walk @it to the element at position @i of the queue from the nearer end */
+static element_t *walk_to(q_iter_t *it, int i)
+{
+    element_t *e;
+    if (i < current->size / 2) {
+        e = q_iter_first(it, current->q);
+        for (int k = 0; k < i; k++)
+            e = q_iter_next(it);
+    } else {
+        e = q_iter_last(it, current->q);
+        for (int k = current->size - 1; k > i; k--)
+            e = q_iter_prev(it);
+    }
+    return e;
+}
+
+static bool do_get(int argc, char *argv[])
+{
+    if (argc != 2 && argc != 3) {
+        report(1, "%s needs 1-2 arguments", argv[0]);
+        return false;
+    }
+
+    int i, reps = 1;
+    if (!get_int(argv[1], &i)) {
+        report(1, "Invalid position '%s'", argv[1]);
+        return false;
+    }
+    if (argc == 3 && !get_int(argv[2], &reps)) {
+        report(1, "Invalid number of calls to get '%s'", argv[2]);
+        return false;
+    }
+
+    if (!current || !current->q) {
+        report(3, "Warning: Try to access null queue");
+        return false;
+    }
+    error_check();
+
+    bool ok = true;
+    element_t *e = NULL;
+    q_iter_t it;
+    if (exception_setup(true)) {
+        for (int r = 0; ok && r < reps; r++) {
+            e = q_get(current->q, i);
+            ok = ok && !error_check();
+        }
+    }
+    exception_cancel();
+
+    if (ok) {
+        bool in_range = i >= 0 && i < current->size;
+        if (!in_range && e) {
+            report(1, "ERROR: Got an element at invalid position %d", i);
+            ok = false;
+        } else if (in_range && (!e || e != walk_to(&it, i))) {
+            report(1, "ERROR: Got a wrong element at position %d", i);
+            ok = false;
+        } else if (e) {
+            report(2, "Element at %d = %s", i, e->value);
+        } else {
+            report(2, "Position %d is out of range", i);
+        }
+    }
+
+    return ok && !error_check();
+}
+
+static bool do_da(int argc, char *argv[])
+{
+    if (argc != 2 && argc != 3) {
+        report(1, "%s needs 1-2 arguments", argv[0]);
+        return false;
+    }
+
+    int i, reps = 1;
+    if (!get_int(argv[1], &i)) {
+        report(1, "Invalid position '%s'", argv[1]);
+        return false;
+    }
+    if (argc == 3 && !get_int(argv[2], &reps)) {
+        report(1, "Invalid number of deletions '%s'", argv[2]);
+        return false;
+    }
+
+    if (!current || !current->q) {
+        report(3, "Warning: Try to access null queue");
+        return false;
+    }
+    error_check();
+
+    bool ok = true;
+    if (exception_setup(true)) {
+        /* Deleting at a fixed position removes consecutive nodes. Deletions
+         * may move the remaining elements around, so the neighbours of each
+         * target are looked up again from the nearer end.
+         */
+        for (int r = 0; ok && r < reps; r++) {
+            bool in_range = i >= 0 && i < current->size;
+            element_t *prev = NULL, *next = NULL;
+            q_iter_t it;
+            if (in_range) {
+                walk_to(&it, i);
+                q_iter_t before = it;
+                prev = q_iter_prev(&before);
+                next = q_iter_next(&it);
+            }
+            bool rval = q_delete_at(current->q, i);
+            if (rval)
+                current->size--;
+            if (rval != in_range) {
+                report(1, "ERROR: Deletion at position %d should %s", i,
+                       in_range ? "succeed" : "fail");
+                ok = false;
+            } else if (!rval) {
+                report(2, "Position %d is out of range", i);
+                break;
+            } else {
+                /* The neighbours of the deleted node must have closed up */
+                bool closed = true;
+                if (next) {
+                    closed = walk_to(&it, i) == next;
+                    closed = closed && q_iter_prev(&it) == prev;
+                } else if (prev) {
+                    closed = walk_to(&it, i - 1) == prev;
+                    closed = closed && !q_iter_next(&it);
+                }
+                if (!closed) {
+                    report(1, "ERROR: Deleted a wrong node at position %d", i);
+                    ok = false;
+                }
+            }
+            ok = ok && !error_check();
+        }
+    }
     exception_cancel();
 
-    if (!current->size)
-        report(3, "Warning: Try to delete middle node to empty queue");
-    else
-        --current->size;
     q_show(3);
     return ok && !error_check();
 }
@@ -740,19 +1120,18 @@ static bool do_ascend(int argc, char *argv[])
     error_check();
 
     if (exception_setup(true))
-        current->size = q_ascend(current->q);
+        current->size = q_ascend_cmp(current->q, order_cmp());
     set_noallocate_mode(false);
 
     bool ok = true;
 
     cnt = current->size;
     if (current->size) {
-        for (struct list_head *cur_l = current->q->next;
-             cur_l != current->q && --cnt; cur_l = cur_l->next) {
-            element_t *item, *next_item;
-            item = list_entry(cur_l, element_t, list);
-            next_item = list_entry(cur_l->next, element_t, list);
-            if (strcmp(item->value, next_item->value) > 0) {
+        q_iter_t it;
+        element_t *item, *next_item;
+        for (item = q_iter_first(&it, current->q);
+             --cnt && (next_item = q_iter_next(&it)); item = next_item) {
+            if (value_cmp(item->value, next_item->value) > 0) {
                 report(1,
                        "ERROR: At least one node violated the ordering rule");
                 ok = false;
@@ -787,19 +1166,18 @@ static bool do_descend(int argc, char *argv[])
     error_check();
 
     if (exception_setup(true))
-        current->size = q_descend(current->q);
+        current->size = q_descend_cmp(current->q, order_cmp());
     set_noallocate_mode(false);
 
     bool ok = true;
 
     cnt = current->size;
     if (current->size) {
-        for (struct list_head *cur_l = current->q->next;
-             cur_l != current->q && --cnt; cur_l = cur_l->next) {
-            element_t *item, *next_item;
-            item = list_entry(cur_l, element_t, list);
-            next_item = list_entry(cur_l->next, element_t, list);
-            if (strcmp(item->value, next_item->value) < 0) {
+        q_iter_t it;
+        element_t *item, *next_item;
+        for (item = q_iter_first(&it, current->q);
+             --cnt && (next_item = q_iter_next(&it)); item = next_item) {
+            if (value_cmp(item->value, next_item->value) < 0) {
                 report(1,
                        "ERROR: At least one node violated the ordering rule");
                 ok = false;
@@ -858,11 +1236,11 @@ static bool do_merge(int argc, char *argv[])
     int len = 0;
     set_noallocate_mode(true);
     if (current && exception_setup(true))
-        len = q_merge(&chain.head, descend);
+        len = q_merge_cmp(&chain.head, order_cmp(), descend);
     exception_cancel();
     set_noallocate_mode(false);
 
-    if (q_size(&chain.head) > 1) {
+    if (chain.size > 1) {
         chain.size = 1;
         current = list_entry(chain.head.next, queue_contex_t, chain);
         current->size = len;
@@ -881,13 +1259,12 @@ static bool do_merge(int argc, char *argv[])
 
     bool ok = true;
     if (current && current->size) {
-        for (struct list_head *cur_l = current->q->next;
-             cur_l != current->q && --len; cur_l = cur_l->next) {
+        q_iter_t it;
+        element_t *item, *next_item;
+        for (item = q_iter_first(&it, current->q);
+             --len && (next_item = q_iter_next(&it)); item = next_item) {
             /* Ensure each element in ascending order */
-            element_t *item, *next_item;
-            item = list_entry(cur_l, element_t, list);
-            next_item = list_entry(cur_l->next, element_t, list);
-            if (!descend && strcmp(item->value, next_item->value) > 0) {
+            if (!descend && value_cmp(item->value, next_item->value) > 0) {
                 report(1,
                        "ERROR: Not sorted in ascending order (It might because "
                        "of unsorted queues are merged or there're some flaws "
@@ -897,7 +1274,7 @@ static bool do_merge(int argc, char *argv[])
             }
 
 
-            if (descend && strcmp(item->value, next_item->value) < 0) {
+            if (descend && value_cmp(item->value, next_item->value) < 0) {
                 report(
                     1,
                     "ERROR: Not sorted in descending order (It might because "
@@ -913,65 +1290,38 @@ static bool do_merge(int argc, char *argv[])
     return ok && !error_check();
 }
 
-static bool is_circular()
-{
-    struct list_head *cur = current->q->next;
-    struct list_head *fast = (cur) ? cur->next : NULL;
-    while (cur != current->q) {
-        if (!cur || !fast || !fast->next)
-            return false;
-        if (cur == fast)
-            return false;
-        cur = cur->next;
-        fast = fast->next->next;
-    }
-
-    cur = current->q->prev;
-    fast = (cur) ? cur->prev : NULL;
-    while (cur != current->q) {
-        if (!cur || !fast || !fast->prev)
-            return false;
-        cur = cur->prev;
-        fast = fast->prev->prev;
-    }
-    return true;
-}
-
 static bool q_show(int vlevel)
 {
     bool ok = true;
     if (verblevel < vlevel)
         return true;
 
-    int cnt = 0;
+    int cnt = 0, len;
     if (!current || !current->q) {
         report(vlevel, "l = NULL");
         return true;
     }
 
-    if (!is_circular()) {
+    if (!q_check(current->q, &len)) {
         report(vlevel, "ERROR:  Queue is not doubly circular");
         return false;
     }
 
     report_noreturn(vlevel, "l = [");
 
-    struct list_head *ori = current->q;
-    struct list_head *cur = current->q->next;
+    q_iter_t it;
+    element_t *e = q_iter_first(&it, current->q);
 
     if (exception_setup(true)) {
-        while (ok && ori != cur && cnt < current->size) {
-            element_t *e = list_entry(cur, element_t, list);
-            if (cnt < BIG_LIST_SIZE) {
-                report_noreturn(vlevel, cnt == 0 ? "%s" : " %s", e->value);
-                if (show_entropy) {
-                    report_noreturn(
-                        vlevel, "(%3.2f%%)",
-                        shannon_entropy((const uint8_t *) e->value));
-                }
+        /* The length is already known, so only the shown elements are read */
+        while (ok && e && cnt < current->size && cnt < BIG_LIST_SIZE) {
+            report_noreturn(vlevel, cnt == 0 ? "%s" : " %s", e->value);
+            if (show_entropy) {
+                report_noreturn(vlevel, "(%3.2f%%)",
+                                shannon_entropy((const uint8_t *) e->value));
             }
             cnt++;
-            cur = cur->next;
+            e = q_iter_next(&it);
             ok = ok && !error_check();
         }
     }
@@ -982,8 +1332,8 @@ static bool q_show(int vlevel)
         return false;
     }
 
-    if (cur == ori) {
-        if (cnt <= BIG_LIST_SIZE)
+    if (len <= current->size) {
+        if (len <= BIG_LIST_SIZE)
             report(vlevel, "]");
         else
             report(vlevel, " ... ]");
@@ -1056,38 +1406,47 @@ static bool do_next(int argc, char *argv[])
     return q_show(0);
 }
 
-void __entry_swap(struct list_head *a, struct list_head *b)
-{
-    element_t *a_entry = list_entry(a, element_t, list),
-              *b_entry = list_entry(b, element_t, list);
-    a_entry->value =
-        (char *) ((uintptr_t) a_entry->value ^ (uintptr_t) b_entry->value);
-    b_entry->value =
-        (char *) ((uintptr_t) a_entry->value ^ (uintptr_t) b_entry->value);
-    a_entry->value =
-        (char *) ((uintptr_t) a_entry->value ^ (uintptr_t) b_entry->value);
-}
+/* State of the generator driving shuffle */
+static uintptr_t shuffle_state;
 
-void q_shuffle(struct list_head *head)
+static bool do_shuffle(int argc, char *argv[])
 {
-    int size = q_size(head);
-    struct list_head *new_node = head;
-    for (int i = size; size > 1; size--) {
-        int old = rand() % i + 1;
-        struct list_head *old_node = head;
-        for (int j = 0; j < old; j++, old_node = old_node->next)
-            ;
-        new_node = new_node->prev;
-        if (new_node == old_node)
-            continue;
-        __entry_swap(old_node, new_node);
+    if (argc != 1) {
+        report(1, "%s takes no arguments", argv[0]);
+        return false;
+    }
+
+    if (!current || !current->q) {
+        report(3, "Warning: Calling shuffle on null queue");
+        return false;
     }
+    error_check();
+
+    /* The snapshot comes from the system allocator, so the failures and
+     * limits imposed on the queue code do not apply to it
+     */
+    struct list_head **nodes =
+        malloc(sizeof(struct list_head *) * (q_size(current->q) + 1));
+    if (!nodes) {
+        report(1, "INTERNAL ERROR.  Could not allocate space for shuffle");
+        return false;
+    }
+    q_shuffle(current->q, nodes, &shuffle_state);
+    free(nodes);
+    return q_show(0);
 }
 
-static bool do_shuffle(int argc, char *argv[])
+static bool do_memstat(int argc, char *argv[])
 {
-    q_shuffle(current->q);
-    return q_show(0);
+    if (argc != 1) {
+        report(1, "%s takes no arguments", argv[0]);
+        return false;
+    }
+
+    if (!mem_profile)
+        report(1, "Warning: profiling is off, use 'option profile 1'");
+    profile_show();
+    return true;
 }
 
 static void console_init()
@@ -1116,8 +1475,17 @@ static void console_init()
     ADD_COMMAND(sort, "Sort queue in ascending/descening order", "");
     ADD_COMMAND(size, "Compute queue size n times (default: n == 1)", "[n]");
     ADD_COMMAND(show, "Show queue contents", "");
-    ADD_COMMAND(dm, "Delete middle node in queue", "");
-    ADD_COMMAND(dedup, "Delete all nodes that have duplicate string", "");
+    ADD_COMMAND(dm, "Delete middle node in queue, n times (default: n == 1)",
+                "[n]");
+    ADD_COMMAND(get, "Get the element at position i, n times (default: n == 1)",
+                "i [n]");
+    ADD_COMMAND(da,
+                "Delete the element at position i, n times (default: n == 1)",
+                "i [n]");
+    ADD_COMMAND(dedup,
+                "Delete all nodes that have duplicate string. With 'hash', "
+                "the queue does not need to be sorted",
+                "[hash]");
     ADD_COMMAND(merge, "Merge all the queues into one sorted queue", "");
     ADD_COMMAND(swap, "Swap every two adjacent nodes in queue", "");
     ADD_COMMAND(ascend,
@@ -1133,14 +1501,39 @@ static void console_init()
     ADD_COMMAND(reverseK, "Reverse the nodes of the queue 'K' at a time",
                 "[K]");
     ADD_COMMAND(shuffle, "Randomly shuffle the nodes in the queue", "");
+    ADD_COMMAND(memstat, "Show allocations made by each command", "");
     add_param("length", &string_length, "Maximum length of displayed string",
               NULL);
     add_param("malloc", &fail_probability, "Malloc failure probability percent",
               NULL);
+    add_param("seed", &fail_seed,
+              "Seed of malloc failures, making them reproducible (0: random)",
+              reseed_failures);
+    add_param("fill", &fill_blocks,
+              "Fill allocated and freed blocks with a pattern", NULL);
+    add_param("profile", &mem_profile,
+              "Profile allocations made by the queue (see memstat)", NULL);
     add_param("fail", &fail_limit,
               "Number of times allow queue operations to return false", NULL);
     add_param("descend", &descend,
               "Sort and merge queue in ascending/descending order", NULL);
+    add_param("sortalgo", &sort_algo,
+              "Sort algorithm (0: natural merge sort, 1: MSD radix sort)",
+              NULL);
+    add_param("order", &value_order,
+              "Order of values (0: strcmp, 1: numeric, 2: case-insensitive, "
+              "3: length)",
+              NULL);
+    add_param("dmindex", &dm_index,
+              "Delete middle node through the positional index (see get)",
+              NULL);
+    add_param("threads", &sort_threads, "Number of threads used by sort",
+              NULL);
+    add_param("own", &own_strings,
+              "Hand inserted strings over to the queue instead of copying",
+              NULL);
+    add_param("intern", &intern_strings,
+              "Share one pooled copy of each distinct inserted string", NULL);
 }
 
 /* Signal handlers */
@@ -1173,9 +1566,6 @@ static void q_init()
 static bool q_quit(int argc, char *argv[])
 {
     report(3, "Freeing queue");
-    if (current && current->size > BIG_LIST_SIZE)
-        set_cautious_mode(false);
-
     if (exception_setup(true)) {
         struct list_head *cur = chain.head.next;
         while (chain.size > 0) {
@@ -1188,7 +1578,6 @@ static bool q_quit(int argc, char *argv[])
     }
 
     exception_cancel();
-    set_cautious_mode(true);
 
     size_t bcnt = allocation_check();
     if (bcnt > 0) {
@@ -1202,11 +1591,12 @@ static bool q_quit(int argc, char *argv[])
 
 static void usage(char *cmd)
 {
-    printf("Usage: %s [-h] [-f IFILE][-v VLEVEL][-l LFILE]\n", cmd);
+    printf("Usage: %s [-h] [-f IFILE][-v VLEVEL][-l LFILE][-p PFILE]\n", cmd);
     printf("\t-h         Print this information\n");
     printf("\t-f IFILE   Read commands from IFILE\n");
     printf("\t-v VLEVEL  Set verbosity level\n");
     printf("\t-l LFILE   Echo results to LFILE\n");
+    printf("\t-p PFILE   Profile allocations and write them to PFILE\n");
     exit(0);
 }
 
@@ -1416,10 +1806,12 @@ int main(int argc, char *argv[])
     char *infile_name = NULL;
     char lbuf[BUFSIZE];
     char *logfile_name = NULL;
+    char pbuf[BUFSIZE];
+    char *profile_name = NULL;
     int level = 4;
     int c;
 
-    while ((c = getopt(argc, argv, "hv:f:l:")) != -1) {
+    while ((c = getopt(argc, argv, "hv:f:l:p:")) != -1) {
         switch (c) {
         case 'h':
             usage(argv[0]);
@@ -1444,6 +1836,12 @@ int main(int argc, char *argv[])
             buf[BUFSIZE - 1] = '\0';
             logfile_name = lbuf;
             break;
+        case 'p':
+            strncpy(pbuf, optarg, BUFSIZE);
+            pbuf[BUFSIZE - 1] = '\0';
+            profile_name = pbuf;
+            mem_profile = 1;
+            break;
         default:
             printf("Unknown option '%c'\n", c);
             usage(argv[0]);
@@ -1454,7 +1852,8 @@ int main(int argc, char *argv[])
     /* A better seed can be obtained by combining getpid() and its parent ID
      * with the Unix time.
      */
-    srand(os_random(getpid() ^ getppid()));
+    shuffle_state = os_random(getpid() ^ getppid());
+    srand(shuffle_state);
 
     q_init();
     init_cmd();
@@ -1483,5 +1882,10 @@ int main(int argc, char *argv[])
     /* Do finish_cmd() before check whether ok is true or false */
     ok = finish_cmd() && ok;
 
+    if (profile_name && !profile_dump(profile_name)) {
+        fprintf(stderr, "Couldn't write profile to %s\n", profile_name);
+        ok = false;
+    }
+
     return !ok;
 }
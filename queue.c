@@ -1,8 +1,8 @@
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#include "queue.h"
+#include "queue_common.h"
+#include "random.h"
 
 /* Notice: sometimes, Cppcheck would find the potential NULL pointer bugs,
  * but some of them cannot occur. You can suppress them by adding the
@@ -10,15 +10,126 @@
  *   cppcheck-suppress nullPointer
  */
 
+/* Replace the prefix of every element of @head by its numeric key if @keyed
+ * is set, or put the prefix back otherwise.
+ */
+static void __set_keys(struct list_head *head, bool keyed)
+{
+    element_t *e;
+    list_for_each_entry (e, head, list)
+        e->prefix = __key(e, keyed);
+}
+
+/* The positional index samples every stride-th node of a queue. It is built
+ * on demand and marked stale by every operation relinking the queue.
+ */
+struct pos_index {
+    struct list_head **samples;
+    int len, cap;
+    int stride;
+    bool stale;
+};
+
+/* Do not sample more often than this */
+#define INDEX_STRIDE_MIN 32
+
+static inline void __index_stale(struct list_head *head)
+{
+    queue_t *q = queue_of(head);
+    if (q->index)
+        q->index->stale = true;
+}
+
+static void __index_free(queue_t *q)
+{
+    if (q->index) {
+        free(q->index->samples);
+        free(q->index);
+    }
+}
+
+/* Bring the index of @q up to date. Return false if it cannot be allocated. */
+static bool __index_build(queue_t *q)
+{
+    struct pos_index *index = q->index;
+    if (index && !index->stale)
+        return true;
+
+    if (!index) {
+        index = malloc(sizeof(struct pos_index));
+        if (!index)
+            return false;
+        index->samples = NULL;
+        index->cap = 0;
+        q->index = index;
+    }
+
+    int stride = INDEX_STRIDE_MIN;
+    while ((long) stride * stride < q->size)
+        stride <<= 1;
+    int len = (q->size + stride - 1) / stride;
+
+    if (index->cap < len) {
+        free(index->samples);
+        index->samples = malloc(sizeof(struct list_head *) * len);
+        index->cap = index->samples ? len : 0;
+        if (!index->samples) {
+            index->stale = true;
+            return false;
+        }
+    }
+
+    struct list_head *node = q->head.next;
+    for (int i = 0; i < q->size; i++, node = node->next) {
+        if (!(i % stride))
+            index->samples[i / stride] = node;
+    }
+    index->len = len;
+    index->stride = stride;
+    index->stale = false;
+    return true;
+}
+
+/* Find the node at position @i of @q, which must be in range */
+static struct list_head *__index_seek(queue_t *q, int i)
+{
+    struct list_head *node;
+
+    if (__index_build(q)) {
+        node = q->index->samples[i / q->index->stride];
+        for (int k = i % q->index->stride; k; k--)
+            node = node->next;
+    } else if (i < q->size / 2) {
+        node = q->head.next;
+        for (int k = i; k; k--)
+            node = node->next;
+    } else {
+        node = q->head.prev;
+        for (int k = q->size - 1 - i; k; k--)
+            node = node->prev;
+    }
+    return node;
+}
+
 /* Create an empty queue */
 struct list_head *q_new()
 {
-    struct list_head *new_head = malloc(sizeof(struct list_head));
-    if (new_head) {
-        new_head->next = new_head;
-        new_head->prev = new_head;
+    queue_t *q = malloc(sizeof(queue_t));
+    if (!q)
+        return NULL;
+    /* Set up the first slab right away, so that inserting into an empty
+     * queue costs the same as inserting into a non-empty one.
+     */
+    q->slab = slab_new(q, SLAB_SIZE);
+    if (!q->slab) {
+        free(q);
+        return NULL;
     }
-    return new_head;
+    INIT_LIST_HEAD(&q->head);
+    q->size = 0;
+    q->index = NULL;
+    q->reversed = false;
+    return &q->head;
 }
 
 /* Free all storage used by queue */
@@ -31,50 +142,103 @@ void q_free(struct list_head *head)
         q_release_element(entry);
     }
 
-    free(head);
+    slab_retire(queue_of(head)->slab);
+    __index_free(queue_of(head));
+    free(queue_of(head));
 }
 
-
-bool __q_insert(struct list_head *head,
-                char *s,
-                void (*add_func)(struct list_head *node,
-                                 struct list_head *head))
+/* Link a new element holding @s into @head, see __element_new() */
+bool __q_insert(struct list_head *head, char *s, bool tail, bool owned)
 {
     if (head) {
-        element_t *new_node = malloc(sizeof(element_t));
+        size_t len = strlen(s);
+        element_t *new_node = __element_new(queue_of(head), s, len, owned, 0);
         if (new_node) {
-            size_t size = strlen(s) + 1;
-            new_node->value = malloc(sizeof(char) * size);
-            if (new_node->value) {
-                strncpy(new_node->value, s, size);
-                add_func(&new_node->list, head);
-                // cppcheck-suppress memleak
-                return true;
-            }
-            free(new_node);
+            if (tail != queue_of(head)->reversed)
+                list_add_tail(&new_node->list, head);
+            else
+                list_add(&new_node->list, head);
+            queue_of(head)->size++;
+            __index_stale(head);
+            return true;
         }
     }
     return false;
 }
 
-/* Insert an element at head of queue */
-bool q_insert_head(struct list_head *head, char *s)
+/* Insert @n strings, taken from @strs or else one after another from @buf.
+ *
+ * The space for the batch is sized up front and reserved in as few slabs as
+ * possible. The new elements are chained up on their own and then spliced
+ * into the queue, so either all of them are inserted or none is.
+ */
+bool __q_insert_bulk(struct list_head *head,
+                     const char **strs,
+                     const char *buf,
+                     size_t n,
+                     bool tail)
 {
-    return __q_insert(head, s, list_add);
-}
+    if (head == NULL || (strs == NULL && buf == NULL))
+        return false;
+    if (n == 0)
+        return true;
 
-/* Insert an element at tail of queue */
-bool q_insert_tail(struct list_head *head, char *s)
-{
-    return __q_insert(head, s, list_add_tail);
+    size_t left = 0;
+    const char *s = buf;
+    for (size_t i = 0; i < n; i++) {
+        const char *str = strs ? strs[i] : s;
+        size_t len = strlen(str);
+        left += SLOT_SIZE(intern_strings ? 0 : len);
+        s = str + len + 1;
+    }
+
+    /* Chain the batch in the order it is laid out in the list */
+    queue_t *q = queue_of(head);
+    bool at_tail = tail != q->reversed;
+    LIST_HEAD(batch);
+    s = buf;
+    size_t i = 0;
+    for (; i < n; i++) {
+        const char *str = strs ? strs[i] : s;
+        size_t len = strlen(str);
+        element_t *new_node = __element_new(
+            q, str, len, false, left < BULK_SLAB ? left : BULK_SLAB);
+        if (!new_node)
+            break;
+        left -= SLOT_SIZE(intern_strings ? 0 : len);
+        if (at_tail)
+            list_add_tail(&new_node->list, &batch);
+        else
+            list_add(&new_node->list, &batch);
+        s = str + len + 1;
+    }
+
+    if (i < n) {
+        element_t *entry, *safe;
+        list_for_each_entry_safe (entry, safe, &batch, list)
+            q_release_element(entry);
+        return false;
+    }
+
+    if (at_tail)
+        list_splice_tail(&batch, head);
+    else
+        list_splice(&batch, head);
+    q->size += n;
+    __index_stale(head);
+    return true;
 }
 
-#define __remove(link)                                                     \
+#define __remove(tail)                                                     \
     {                                                                      \
         if (head && list_empty(head) == 0) {                               \
-            struct list_head *target = head->link;                         \
+            struct list_head *target =                                     \
+                (tail) != queue_of(head)->reversed ? head->prev            \
+                                                   : head->next;           \
             element_t *target_entry = list_entry(target, element_t, list); \
             list_del(target);                                              \
+            queue_of(head)->size--;                                        \
+            __index_stale(head);                                           \
             if (sp) {                                                      \
                 strncpy(sp, target_entry->value, bufsize - 1);             \
                 sp[bufsize - 1] = '\0';                                    \
@@ -87,70 +251,163 @@ bool q_insert_tail(struct list_head *head, char *s)
 /* Remove an element from head of queue */
 element_t *q_remove_head(struct list_head *head, char *sp, size_t bufsize)
 {
-    __remove(next);
+    __remove(false);
 }
 
 /* Remove an element from tail of queue */
 element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize)
 {
-    __remove(prev);
+    __remove(true);
 }
 
-/* Return number of elements in queue */
-int q_size(struct list_head *head)
+/* Delete the middle node in queue */
+bool q_delete_mid(struct list_head *head)
 {
-    struct list_head *node = NULL;
-    int size = 0;
-    list_for_each (node, head) {
-        size++;
+    if (head == NULL || list_empty(head))
+        return false;
+    /* Walk in from both ends until the cursors meet, in the middle node of an
+     * odd queue or the two middle nodes of an even one.
+     */
+    struct list_head *front = head->next, *back = head->prev;
+    while (front != back && front->next != back) {
+        front = front->next;
+        back = back->prev;
     }
-    return size;
+    /* Counted from the other end, the middle of an even queue is one earlier */
+    struct list_head *mid = queue_of(head)->reversed ? front : back;
+    list_del(mid);
+    queue_of(head)->size--;
+    __index_stale(head);
+    q_release_element(list_entry(mid, element_t, list));
+
+    return true;
 }
 
-/* Delete the middle node in queue */
-bool q_delete_mid(struct list_head *head)
+/* Get the element at position i */
+element_t *q_get(struct list_head *head, int i)
 {
-    if (head == NULL || list_empty(head))
+    if (head == NULL || i < 0 || i >= q_size(head))
+        return NULL;
+    queue_t *q = queue_of(head);
+    if (q->reversed)
+        i = q->size - 1 - i;
+    return list_entry(__index_seek(q, i), element_t, list);
+}
+
+/* Delete the element at position i */
+bool q_delete_at(struct list_head *head, int i)
+{
+    if (head == NULL || i < 0 || i >= q_size(head))
         return false;
-    struct list_head *slow = head->next, *fast = head->next->next;
-    while (fast != head && fast->prev != head) {
-        slow = slow->next;
-        fast = fast->next->next;
+
+    queue_t *q = queue_of(head);
+    if (q->reversed)
+        i = q->size - 1 - i;
+    struct list_head *node = __index_seek(q, i);
+    struct pos_index *index = q->index;
+
+    /* Each sample past the deleted node moves one position forward */
+    if (index && !index->stale) {
+        int j = i / index->stride;
+        if (index->samples[j] != node)
+            j++;
+        for (; j < index->len; j++) {
+            index->samples[j] = index->samples[j]->next;
+            if (index->samples[j] == head) {
+                index->len = j;
+                break;
+            }
+        }
     }
-    list_del(slow);
-    element_t *target = list_entry(slow, element_t, list);
-    q_release_element(target);
 
+    list_del(node);
+    q->size--;
+    q_release_element(list_entry(node, element_t, list));
     return true;
 }
 
-/* Delete all nodes that have duplicate string */
-bool q_delete_dup(struct list_head *head)
+/* Delete all nodes whose string @cmp finds equal to a neighbour's */
+bool q_delete_dup_cmp(struct list_head *head, q_cmp_t cmp)
 {
     if (head == NULL || list_empty(head))
         return false;
     if (list_is_singular(head))
         return true;
+    __index_stale(head);
+    queue_t *q = queue_of(head);
     element_t *entry = NULL, *safe = NULL, *delete_target = NULL;
     list_for_each_entry_safe (entry, safe, head, list) {
-        if (entry->list.next != head &&
-            strcmp(safe->value, entry->value) == 0) {
+        if (entry->list.next != head && __compare(safe, entry, cmp) == 0) {
             list_del(&entry->list);
             q_release_element(entry);
+            q->size--;
             delete_target = safe;
         }
         if (delete_target == entry) {
             list_del(&entry->list);
             q_release_element(entry);
+            q->size--;
         }
     }
     return true;
 }
 
-/* Swap every two adjacent nodes */
-void q_swap(struct list_head *head)
+/* Entry of the open addressing table used by q_delete_dup_hash() */
+struct dup_entry {
+    element_t *first; /* first element seen with this value */
+    uint32_t hash;
+    bool dup; /* @first has been unlinked as a duplicate */
+};
+
+/* Delete all nodes whose string occurs more than once, in any order */
+bool q_delete_dup_hash(struct list_head *head)
 {
-    q_reverseK(head, 2);
+    if (head == NULL || list_empty(head))
+        return false;
+    if (list_is_singular(head))
+        return true;
+
+    queue_t *q = queue_of(head);
+    size_t cap = 1;
+    while (cap < (size_t) q->size * 2)
+        cap <<= 1;
+    struct dup_entry *table = calloc(cap, sizeof(struct dup_entry));
+    if (!table)
+        return false;
+    __index_stale(head);
+
+    /* First occurrences of duplicated strings are parked here, so that later
+     * occurrences can still be compared against them.
+     */
+    LIST_HEAD(graveyard);
+    element_t *entry = NULL, *safe = NULL;
+    list_for_each_entry_safe (entry, safe, head, list) {
+        uint32_t hash = __hash(entry->value);
+        size_t i = hash & (cap - 1);
+        for (; table[i].first; i = (i + 1) & (cap - 1)) {
+            if (table[i].hash == hash && !__cmp(table[i].first, entry))
+                break;
+        }
+
+        if (!table[i].first) {
+            table[i].first = entry;
+            table[i].hash = hash;
+            continue;
+        }
+        if (!table[i].dup) {
+            list_move(&table[i].first->list, &graveyard);
+            table[i].dup = true;
+            q->size--;
+        }
+        list_del(&entry->list);
+        q_release_element(entry);
+        q->size--;
+    }
+
+    list_for_each_entry_safe (entry, safe, &graveyard, list)
+        q_release_element(entry);
+    free(table);
+    return true;
 }
 
 /* Reverse the linklist nodes from start to end */
@@ -166,90 +423,110 @@ void __reverse(struct list_head *start, struct list_head *end)
     } while (start != end);
 }
 
-/* Reverse elements in queue */
-void q_reverse(struct list_head *head)
+/* Relink a reversed queue from head to tail and clear its reversed flag */
+static void __normalize(struct list_head *head)
 {
-    if (head == NULL || list_empty(head) || list_is_singular(head))
+    queue_t *q = queue_of(head);
+    if (!q->reversed)
         return;
-    __reverse(head, head);
+    if (!list_empty(head) && !list_is_singular(head)) {
+        __reverse(head, head);
+        __index_stale(head);
+    }
+    q->reversed = false;
 }
 
-int __move_k(struct list_head *head, struct list_head **node, int k)
+/* Reverse elements in queue */
+void q_reverse(struct list_head *head)
 {
-    int i = 0;
-    for (; i < k && (*node)->next != head; i++, *node = (*node)->next)
-        ;
-    return i;
+    if (head == NULL || list_empty(head) || list_is_singular(head))
+        return;
+    /* Positions are mapped through the flag, so the index stays valid */
+    queue_of(head)->reversed = !queue_of(head)->reversed;
 }
 
-void __reverse_k(struct list_head *start, struct list_head *end)
+/* Reverse the group of up to @k nodes following @anchor in queue order, by
+ * moving each node after the first one in front of the group as it is
+ * reached. Return the number of nodes in the group.
+ */
+static int __reverse_group(struct list_head *head,
+                           struct list_head *anchor,
+                           int k,
+                           bool reversed)
 {
-    struct list_head *l = start->prev, *r = end->next;
-    __reverse(start, end);
-    l->next = end;
-    end->prev = l;
-    r->prev = start;
-    start->next = r;
+    struct list_head *first = reversed ? anchor->prev : anchor->next;
+    int n = 1;
+    for (; n < k; n++) {
+        struct list_head *node = reversed ? first->prev : first->next;
+        if (node == head)
+            break;
+        list_del(node);
+        if (reversed)
+            list_add_tail(node, anchor);
+        else
+            list_add(node, anchor);
+    }
+    return n;
 }
 
-/* Reverse the nodes of the list k at a time */
+/* Reverse the nodes of the list k at a time
+ *
+ * Each group is reversed while it is walked for the first time. Only a short
+ * last group, which has to stay as it was, is reversed a second time.
+ */
 void q_reverseK(struct list_head *head, int k)
 {
-    if (head == NULL || list_empty(head) || list_is_singular(head))
+    if (head == NULL || list_empty(head) || list_is_singular(head) || k < 2)
         return;
-    struct list_head *start = head->next, *end = head;
-    int i = __move_k(head, &end, k);
-    while (i == k) {
-        struct list_head *next_start = start, *next_end = end;
-
-        __move_k(head, &next_start, k);
-        i = __move_k(head, &next_end, k);
-
-        __reverse_k(start, end);
-        start = next_start;
-        end = next_end;
-    }
-}
-
-struct list_head *__merge(struct list_head *l, struct list_head *r, bool decend)
-{
-    struct list_head *head = NULL, **tmp = &head, *last = head;
-    while (l != NULL && r != NULL) {
-        char *l_value = list_entry(l, element_t, list)->value,
-             *r_value = list_entry(r, element_t, list)->value;
-
-        struct list_head **indir =
-            ((strcmp(l_value, r_value) > 0) == decend) ? &l : &r;
-        (*indir)->prev = last;
-        *tmp = *indir;
-        last = *tmp;
-
-        *indir = (*indir)->next;
-        tmp = &(*tmp)->next;
+    __index_stale(head);
+    bool reversed = queue_of(head)->reversed;
+    struct list_head *anchor = head;
+    for (;;) {
+        struct list_head *first = reversed ? anchor->prev : anchor->next;
+        if (first == head)
+            break;
+        int n = __reverse_group(head, anchor, k, reversed);
+        if (n < k) {
+            __reverse_group(head, anchor, n, reversed);
+            break;
+        }
+        anchor = first;
     }
-    struct list_head *tail = (l != NULL) ? l : r;
-    *tmp = tail;
-    tail->prev = last;
-    return head;
 }
 
-struct list_head *__merge_sort(struct list_head *l, bool decend)
+/* Shuffle the nodes of the queue with Fisher-Yates over a snapshot of the
+ * node pointers, then relink them in the new order. Nodes are moved rather
+ * than their values, since a value is stored in the same slot as its element.
+ */
+void q_shuffle(struct list_head *head,
+               struct list_head **nodes,
+               uintptr_t *state)
 {
-    if (l == NULL || l->next == NULL) {
-        return l;
-    }
-    struct list_head *r = l, *fast = l;
-    while (fast != NULL && fast->next != NULL) {
-        r = r->next;
-        fast = fast->next->next;
-    }
+    int size = q_size(head);
+    if (size < 2)
+        return;
 
-    r->prev->next = NULL;
-    r->prev = NULL;
+    struct list_head *node;
+    int n = 0;
+    list_for_each (node, head)
+        nodes[n++] = node;
 
-    l = __merge_sort(l, decend), r = __merge_sort(r, decend);
+    for (int i = size - 1; i > 0; i--) {
+        int j = random_next(state) % (i + 1);
+        node = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = node;
+    }
 
-    return __merge(l, r, decend);
+    struct list_head *prev = head;
+    for (int i = 0; i < size; i++) {
+        prev->next = nodes[i];
+        nodes[i]->prev = prev;
+        prev = nodes[i];
+    }
+    prev->next = head;
+    head->prev = prev;
+    __index_stale(head);
 }
 
 void __cut_head(struct list_head *head)
@@ -258,144 +535,138 @@ void __cut_head(struct list_head *head)
     head->prev->next = NULL;
 }
 
-void __link_head(struct list_head *head, struct list_head *start)
-{
-    start->prev = head;
-    head->next = start;
-    struct list_head *end = NULL;
-    for (end = start; end->next != NULL; end = end->next)
-        ;
-    end->next = head;
-    head->prev = end;
-}
-
-
-static struct list_head *merge(struct list_head *a,
-                               struct list_head *b,
-                               bool descend)
+/* Sort elements of queue in the order given by @cmp. The numeric order is
+ * sorted on keys parsed once per element and kept in its prefix meanwhile.
+ */
+void q_sort_cmp(struct list_head *head, q_cmp_t cmp, bool descend)
 {
-    struct list_head *head = NULL, **tail = &head;
+    if (head == NULL || list_empty(head) || list_is_singular(head))
+        return;
 
-    for (;;) {
-        /* if equal, take 'a' -- important for sort stability */
-        const char *l_value = list_entry(a, element_t, list)->value,
-                   *r_value = list_entry(b, element_t, list)->value;
-        if ((strcmp(l_value, r_value) > 0) == descend) {
-            *tail = a;
-            tail = &a->next;
-            a = a->next;
-            if (!a) {
-                *tail = b;
-                break;
-            }
-        } else {
-            *tail = b;
-            tail = &b->next;
-            b = b->next;
-            if (!b) {
-                *tail = a;
-                break;
-            }
-        }
+    bool keyed = cmp == q_cmp_numeric;
+    if (keyed) {
+        __set_keys(head, true);
+        cmp = __numeric_keyed;
     }
-    return head;
-}
 
-void q_sort(struct list_head *head, bool descend)
-{
-    if (head == NULL || list_empty(head) || list_is_singular(head))
-        return;
+    __index_stale(head);
+    /* Sorting the links the other way round and keeping the queue reversed
+     * gives the requested order, and leaves equal elements in queue order.
+     */
+    descend ^= queue_of(head)->reversed;
+    int n = q_size(head);
+    struct list_head *list = head->next;
     __cut_head(head);
-    struct list_head *node = __merge_sort(head->next, descend);
-    __link_head(head, node);
+    __sort_into(head, list, n, descend, cmp);
+
+    if (keyed)
+        __set_keys(head, false);
 }
 
-int __monotonic(struct list_head *head, bool descend)
+int __monotonic(struct list_head *head, bool descend, q_cmp_t cmp)
 {
     if (head == NULL || list_empty(head))
         return 0;
     if (list_is_singular(head))
         return 1;
     int count = 0;
-    const char *last = "\0";
-
-    for (struct list_head *node = (head)->prev, *safe = node->prev;
-         node != (head); node = safe, safe = node->prev) {
-        element_t *entry = list_entry(node, element_t, list);
-        int cmp = strcmp(entry->value, last);
-        if ((cmp < 0) != descend || cmp == 0) {
-            last = entry->value;
-            count++;
-        } else {
-            list_del(&entry->list);
+    bool reversed = queue_of(head)->reversed;
+
+    /* Walk from the tail of the queue towards its head. The nodes between
+     * two kept ones form a run, which is released as the walk passes it and
+     * unlinked in one go once the next kept node is found.
+     */
+    struct list_head *kept = reversed ? head->next : head->prev;
+    while (kept != head) {
+        const element_t *last = list_entry(kept, element_t, list);
+        struct list_head *node = reversed ? kept->next : kept->prev;
+        while (node != head) {
+            element_t *entry = list_entry(node, element_t, list);
+            int c = __compare(entry, last, cmp);
+            if (!c || (c < 0) != descend)
+                break;
+            node = reversed ? node->next : node->prev;
             q_release_element(entry);
         }
+
+        if (reversed) {
+            kept->next = node;
+            node->prev = kept;
+        } else {
+            node->next = kept;
+            kept->prev = node;
+        }
+        kept = node;
+        count++;
     }
+    queue_of(head)->size = count;
+    __index_stale(head);
     return count;
 }
 
-/* Remove every node which has a node with a strictly less value anywhere to
- * the right side of it */
-int q_ascend(struct list_head *head)
-{
-    return __monotonic(head, false);
-}
-
-/* Remove every node which has a node with a strictly greater value anywhere to
- * the right side of it */
-int q_descend(struct list_head *head)
-{
-    return __monotonic(head, true);
-}
-
-/* Merge all the queues into one sorted queue, which is in ascending/descending
- * order */
-int q_merge(struct list_head *head, bool descend)
+/* Merge all the queues, sorted in the order given by @cmp, into one. Like
+ * q_sort_cmp(), the numeric order is merged on keys.
+ */
+int q_merge_cmp(struct list_head *head, q_cmp_t cmp, bool descend)
 {
     if (head == NULL || list_empty(head))
         return 0;
 
-    int cnt = 0;
     struct list_head *q_head = list_first_entry(head, queue_contex_t, chain)->q;
-    queue_contex_t *chain_entry = NULL;
-
-    struct list_head r0, r1;
-    r0.prev = NULL;
-    INIT_LIST_HEAD(&r1);
+    if (!q_head)
+        return 0;
 
-    list_for_each_entry (chain_entry, head, chain) {
-        struct list_head *first = chain_entry->q->next;
-        __cut_head(chain_entry->q);
-        INIT_LIST_HEAD(chain_entry->q);
-        cnt += chain_entry->size;
-        first->prev = r0.prev;
-        r0.prev = first;
-    }
+    bool keyed = cmp == q_cmp_numeric;
+    if (keyed)
+        cmp = __numeric_keyed;
 
-    while (1) {
-        if (r0.prev == NULL || r0.prev->prev == NULL) {
-            r1.next->prev = r0.prev;
-            r0.prev = r1.prev;
-            INIT_LIST_HEAD(&r1);
-        }
-        if (r0.prev->prev == NULL)
-            break;
-        struct list_head *l = r0.prev->prev, *r = r0.prev;
+    struct loser_tree t = {.k = 0, .descend = descend, .cmp = cmp};
+    queue_contex_t *chain_entry = NULL;
+    int cnt = 0;
 
-        r0.prev = l->prev;
-        l = merge(l, r, descend);
-        r1.next->prev = l;
-        r1.next = l;
+    list_for_each_entry (chain_entry, head, chain) {
+        struct list_head *q = chain_entry->q;
+        if (!q || list_empty(q))
+            continue;
+        __normalize(q);
+        if (keyed)
+            __set_keys(q, true);
+
+        __tree_add(&t, q->next);
+        __cut_head(q);
+        INIT_LIST_HEAD(q);
+        cnt += queue_of(q)->size;
+        queue_of(q)->size = 0;
+        __index_stale(q);
     }
 
-    q_head->next = r0.prev;
-    struct list_head *node = q_head;
-
-    for (; node->next != NULL; node = node->next) {
-        node->next->prev = node;
-    }
-    q_head->prev = node;
-    node->next = q_head;
+    if (t.k)
+        __tree_merge(&t, q_head);
+    if (keyed)
+        __set_keys(q_head, false);
+    queue_of(q_head)->size = cnt;
+    queue_of(q_head)->reversed = false;
+    __index_stale(q_head);
 
     return cnt;
 }
+
+/* Check that every node is the prev of its successor, counting the nodes into
+ * @len. A forward walk checking this cannot be trapped in a cycle that misses
+ * the head, and it proves the prev links form the same ring backwards, so one
+ * pass is enough.
+ */
+bool q_check(struct list_head *head, int *len)
+{
+    struct list_head *cur = head;
+    int n = 0;
+    do {
+        struct list_head *next = cur->next;
+        if (!next || next->prev != cur)
+            return false;
+        cur = next;
+        n++;
+    } while (cur != head);
+    *len = n - 1;
+    return true;
+}
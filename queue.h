@@ -4,11 +4,14 @@
 /* This program implements a queue supporting both FIFO and LIFO
  * operations.
  *
- * It uses a circular doubly-linked list to represent the set of queue elements
+ * It uses a circular doubly-linked list to represent the set of queue elements,
+ * or a circular doubly-linked list of blocks of elements when built with
+ * QUEUE=unrolled.
  */
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "harness.h"
 #include "list.h"
@@ -17,14 +20,292 @@
  * element_t - Linked list element
  * @value: pointer to array holding string
  * @list: node of a doubly-linked list
+ * @prefix: first 8 characters of @value packed in big-endian order
  *
- * @value needs to be explicitly allocated and freed
+ * @value needs to be explicitly allocated and freed. Comparing @prefix as an
+ * integer gives the same order as strcmp() on the first 8 characters, so most
+ * comparisons are settled without following @value. A numeric sort or merge
+ * keeps the numeric key of @value in @prefix while it runs.
  */
 typedef struct {
     char *value;
     struct list_head list;
+    uint64_t prefix;
 } element_t;
 
+/**
+ * q_cmp_t - Order of queue values, compared like strcmp() does
+ *
+ * The _cmp variants of the ordering operations take one of these. Passing
+ * NULL selects the default strcmp() order, which is compared on the cached
+ * prefixes without calling through a pointer.
+ */
+typedef int (*q_cmp_t)(const char *a, const char *b);
+
+/* Decimal integers of any length by value, before any other string */
+int q_cmp_numeric(const char *a, const char *b);
+
+/* Case-insensitive order */
+int q_cmp_nocase(const char *a, const char *b);
+
+/* Shorter strings first, then strcmp() order */
+int q_cmp_length(const char *a, const char *b);
+
+/* Block of memory that elements and their strings are carved from */
+struct slab;
+
+#ifdef QUEUE_UNROLLED
+
+/* Number of element pointers held by a block of an unrolled queue */
+#define Q_BLOCK_LEN 64
+
+/**
+ * q_block - Block of consecutive elements of an unrolled queue
+ * @link: node of the circular doubly-linked list of blocks
+ * @start: index of the first element in @elems
+ * @count: number of elements, stored in @elems[@start] onwards
+ * @elems: the elements themselves
+ *
+ * Blocks linked into a queue are never empty.
+ */
+struct q_block {
+    struct list_head link;
+    int start, count;
+    element_t *elems[Q_BLOCK_LEN];
+};
+
+/**
+ * queue_t - Header of a queue created by q_new()
+ * @head: head of the circular doubly-linked list of blocks
+ * @size: the number of elements held by the blocks linked into @head
+ * @slab: slab new elements of this queue are currently carved from
+ * @spare: block left over for the next one needed, if any
+ * @reversed: the blocks run from the tail of the queue to its head
+ *
+ * This is the layout used when built with QUEUE=unrolled. Walking the queue
+ * then follows one link per Q_BLOCK_LEN elements, and positions are found by
+ * skipping whole blocks. The list node inside each element is left for the
+ * operations which chain elements up temporarily, like q_sort().
+ */
+typedef struct {
+    struct list_head head;
+    int size;
+    struct slab *slab;
+    struct q_block *spare;
+    bool reversed;
+} queue_t;
+
+#else
+
+/* Positional index over the nodes of a queue */
+struct pos_index;
+
+/**
+ * queue_t - Header of a queue created by q_new()
+ * @head: head of the circular doubly-linked list of elements
+ * @size: the number of elements currently linked into @head
+ * @slab: slab new elements of this queue are currently carved from
+ * @index: positional index used by q_get() and q_delete_at(), if any
+ * @reversed: the list runs from the tail of the queue to its head
+ *
+ * Callers only hold the address of @head. Every operation that links or
+ * unlinks elements keeps @size up to date, so q_size() is constant time.
+ * q_reverse() only flips @reversed, and the other operations read the list
+ * in the direction it gives.
+ */
+typedef struct {
+    struct list_head head;
+    int size;
+    struct slab *slab;
+    struct pos_index *index;
+    bool reversed;
+} queue_t;
+
+#endif /* QUEUE_UNROLLED */
+
+/**
+ * queue_of() - Get the queue header owning a list head returned by q_new()
+ * @head: header of queue
+ *
+ * Return: the enclosing queue_t
+ */
+static inline queue_t *queue_of(struct list_head *head)
+{
+    return list_entry(head, queue_t, head);
+}
+
+#ifdef QUEUE_UNROLLED
+
+/**
+ * q_iter_t - Cursor over the elements of a queue, from head to tail
+ * @head: header of queue
+ * @block: block the cursor is in, NULL if the cursor is at the head
+ * @i: index of the element the cursor is at in @block->elems
+ * @reversed: copy of the reversed flag of the queue
+ *
+ * Code outside the queue implementation reads queues through q_iter_first()
+ * and q_iter_next() instead of following links, and changes them only through
+ * the q_* operations, so it works the same with either layout. As with a list
+ * node, stepping past either end leaves the cursor at the head, and stepping
+ * on from there wraps around to the other end.
+ */
+typedef struct {
+    struct list_head *head;
+    struct q_block *block;
+    int i;
+    bool reversed;
+} q_iter_t;
+
+/* Return the element the cursor is at, or NULL if it is at the head */
+static inline element_t *__q_iter_entry(q_iter_t *it)
+{
+    return it->block ? it->block->elems[it->i] : NULL;
+}
+
+/* Move @it to the first element of the block after @link, going forward or
+ * backward in memory, or to the head if @link is the last block
+ */
+static inline element_t *__q_iter_enter(q_iter_t *it,
+                                        struct list_head *link,
+                                        bool forward)
+{
+    link = forward ? link->next : link->prev;
+    if (link == it->head) {
+        it->block = NULL;
+        return NULL;
+    }
+    it->block = list_entry(link, struct q_block, link);
+    it->i = forward ? it->block->start
+                    : it->block->start + it->block->count - 1;
+    return __q_iter_entry(it);
+}
+
+/* Step @it to the next element in memory if @forward, or the previous one */
+static inline element_t *__q_iter_step(q_iter_t *it, bool forward)
+{
+    if (!it->block)
+        return __q_iter_enter(it, it->head, forward);
+    struct q_block *b = it->block;
+    if (forward ? ++it->i < b->start + b->count : --it->i >= b->start)
+        return b->elems[it->i];
+    return __q_iter_enter(it, &b->link, forward);
+}
+
+static inline element_t *q_iter_first(q_iter_t *it, struct list_head *head)
+{
+    it->head = head;
+    it->reversed = queue_of(head)->reversed;
+    return __q_iter_enter(it, head, !it->reversed);
+}
+
+static inline element_t *q_iter_next(q_iter_t *it)
+{
+    return __q_iter_step(it, !it->reversed);
+}
+
+static inline element_t *q_iter_last(q_iter_t *it, struct list_head *head)
+{
+    it->head = head;
+    it->reversed = queue_of(head)->reversed;
+    return __q_iter_enter(it, head, it->reversed);
+}
+
+static inline element_t *q_iter_prev(q_iter_t *it)
+{
+    return __q_iter_step(it, it->reversed);
+}
+
+#else
+
+/**
+ * q_iter_t - Cursor over the elements of a queue, from head to tail
+ * @head: header of queue
+ * @node: list node of the element the cursor is at
+ * @reversed: copy of the reversed flag of the queue
+ *
+ * Code outside the queue implementation reads queues through q_iter_first()
+ * and q_iter_next() instead of following links, and changes them only through
+ * the q_* operations, so it works the same with either layout.
+ */
+typedef struct {
+    struct list_head *head, *node;
+    bool reversed;
+} q_iter_t;
+
+/* Return the element of @it->node, or NULL if the cursor is at the head */
+static inline element_t *__q_iter_entry(q_iter_t *it)
+{
+    return it->node == it->head ? NULL : list_entry(it->node, element_t, list);
+}
+
+/**
+ * q_iter_first() - Point a cursor at the first element of a queue
+ * @it: cursor to set up
+ * @head: header of queue
+ *
+ * Return: the first element, or NULL if the queue is empty
+ */
+static inline element_t *q_iter_first(q_iter_t *it, struct list_head *head)
+{
+    it->head = head;
+    it->reversed = queue_of(head)->reversed;
+    it->node = it->reversed ? head->prev : head->next;
+    return __q_iter_entry(it);
+}
+
+/**
+ * q_iter_next() - Advance a cursor to the next element
+ * @it: cursor set up by q_iter_first() or q_iter_last()
+ *
+ * Return: the next element, or NULL once the cursor has passed the tail
+ */
+static inline element_t *q_iter_next(q_iter_t *it)
+{
+    it->node = it->reversed ? it->node->prev : it->node->next;
+    return __q_iter_entry(it);
+}
+
+/**
+ * q_iter_last() - Point a cursor at the last element of a queue
+ * @it: cursor to set up
+ * @head: header of queue
+ *
+ * Return: the last element, or NULL if the queue is empty
+ */
+static inline element_t *q_iter_last(q_iter_t *it, struct list_head *head)
+{
+    it->head = head;
+    it->reversed = queue_of(head)->reversed;
+    it->node = it->reversed ? head->next : head->prev;
+    return __q_iter_entry(it);
+}
+
+/**
+ * q_iter_prev() - Move a cursor back to the previous element
+ * @it: cursor set up by q_iter_first() or q_iter_last()
+ *
+ * Return: the previous element, or NULL once the cursor has passed the head
+ */
+static inline element_t *q_iter_prev(q_iter_t *it)
+{
+    it->node = it->reversed ? it->node->next : it->node->prev;
+    return __q_iter_entry(it);
+}
+
+#endif /* QUEUE_UNROLLED */
+
+/**
+ * q_for_each - Iterate over the elements of a queue
+ * @entry: element_t pointer set to each element in turn
+ * @it: q_iter_t used as the cursor
+ * @head: header of queue
+ *
+ * The queue must not be modified while iterating.
+ */
+#define q_for_each(entry, it, head)                        \
+    for (entry = q_iter_first(&(it), head); entry != NULL; \
+         entry = q_iter_next(&(it)))
+
 /**
  * queue_contex_t - The context managing a chain of queues
  * @q: pointer to the head of the queue
@@ -66,6 +347,12 @@ void q_free(struct list_head *head);
  */
 bool q_insert_head(struct list_head *head, char *s);
 
+/* When set, the insert functions other than q_insert_*_owned() make elements
+ * share one pooled, reference counted copy per distinct string instead of
+ * each getting its own. Equal interned strings then compare by address.
+ */
+extern int intern_strings;
+
 /**
  * q_insert_tail() - Insert an element at the tail
  * @head: header of queue
@@ -78,6 +365,82 @@ bool q_insert_head(struct list_head *head, char *s);
  */
 bool q_insert_tail(struct list_head *head, char *s);
 
+/**
+ * q_insert_head_owned() - Insert an element in the head without copying
+ * @head: header of queue
+ * @s: string to be stored, allocated with malloc()
+ *
+ * Unlike q_insert_head(), the element keeps @s itself, and @s is freed along
+ * with the element by q_release_element(). On failure @s still belongs to the
+ * caller.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_head_owned(struct list_head *head, char *s);
+
+/**
+ * q_insert_tail_owned() - Insert an element at the tail without copying
+ * @head: header of queue
+ * @s: string to be stored, allocated with malloc()
+ *
+ * Like q_insert_head_owned(), at the tail.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_tail_owned(struct list_head *head, char *s);
+
+/**
+ * q_insert_head_bulk() - Insert a batch of elements at the head
+ * @head: header of queue
+ * @strs: array of the strings to be inserted
+ * @n: number of strings in @strs
+ *
+ * Same as calling q_insert_head() on each string in turn, so the last string
+ * ends up first. The elements and copies of the strings are carved from as
+ * few allocations as possible, and the batch is linked into the queue at once.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL,
+ * in which case nothing is inserted
+ */
+bool q_insert_head_bulk(struct list_head *head, const char **strs, size_t n);
+
+/**
+ * q_insert_tail_bulk() - Insert a batch of elements at the tail
+ * @head: header of queue
+ * @strs: array of the strings to be inserted
+ * @n: number of strings in @strs
+ *
+ * Same as calling q_insert_tail() on each string in turn.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL,
+ * in which case nothing is inserted
+ */
+bool q_insert_tail_bulk(struct list_head *head, const char **strs, size_t n);
+
+/**
+ * q_insert_head_buf() - Insert a batch of elements at the head
+ * @head: header of queue
+ * @buf: @n null-terminated strings stored one after another
+ * @n: number of strings in @buf
+ *
+ * Like q_insert_head_bulk(), taking the strings from one buffer.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_head_buf(struct list_head *head, const char *buf, size_t n);
+
+/**
+ * q_insert_tail_buf() - Insert a batch of elements at the tail
+ * @head: header of queue
+ * @buf: @n null-terminated strings stored one after another
+ * @n: number of strings in @buf
+ *
+ * Like q_insert_tail_bulk(), taking the strings from one buffer.
+ *
+ * Return: true for success, false for allocation failed or queue is NULL
+ */
+bool q_insert_tail_buf(struct list_head *head, const char *buf, size_t n);
+
 /**
  * q_remove_head() - Remove the element from head of queue
  * @head: header of queue
@@ -112,18 +475,31 @@ element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize);
  * q_release_element() - Release the element
  * @e: element would be released
  *
+ * The element and its string live in a slab owned by the queue which created
+ * them, so they must be returned through this function rather than free().
+ * A string handed over by q_insert_*_owned() is freed here as well.
  * This function is intended for internal use only.
  */
-static inline void q_release_element(element_t *e)
-{
-    test_free(e->value);
-    test_free(e);
-}
+void q_release_element(element_t *e);
+
+/**
+ * q_check() - Check the links of queue
+ * @head: header of queue
+ * @len: set to the number of elements found by following the links
+ *
+ * Checks that the links of queue form a ring which can be walked both ways.
+ * This function is intended for internal use only.
+ *
+ * Return: true if the links are consistent, false otherwise
+ */
+bool q_check(struct list_head *head, int *len);
 
 /**
  * q_size() - Get the size of the queue
  * @head: header of queue
  *
+ * The size is cached in the queue header, so this runs in constant time.
+ *
  * Return: the number of elements in queue, zero if queue is NULL or empty
  */
 int q_size(struct list_head *head);
@@ -135,6 +511,8 @@ int q_size(struct list_head *head);
  * The middle node of a linked list of size n is the
  * ⌊n / 2⌋th node from the start using 0-based indexing.
  * If there're six elements, the third member should be returned.
+ * It is found by walking in from both ends at once, touching n / 2 nodes, or
+ * by skipping whole blocks in the unrolled layout.
  *
  * Reference:
  * https://leetcode.com/problems/delete-the-middle-node-of-a-linked-list/
@@ -143,6 +521,45 @@ int q_size(struct list_head *head);
  */
 bool q_delete_mid(struct list_head *head);
 
+/**
+ * q_delete_mid_index() - Delete the middle node in queue through the index
+ * @head: header of queue
+ *
+ * Same as q_delete_mid(), but goes through q_delete_at(), so repeated calls
+ * take O(S) steps each rather than walking half of the queue.
+ *
+ * Return: true for success, false if list is NULL or empty.
+ */
+bool q_delete_mid_index(struct list_head *head);
+
+/**
+ * q_get() - Get the element at a given position
+ * @head: header of queue
+ * @i: 0-based position counted from the head
+ *
+ * The first lookup after the queue changed builds a positional index holding
+ * every S-th node, with S about the square root of the queue size. Lookups
+ * then take O(S) steps. The unrolled layout needs no index, and skips whole
+ * blocks in O(n / Q_BLOCK_LEN) steps instead.
+ *
+ * Return: the element at position @i, NULL if queue is NULL or @i is out of
+ * range.
+ */
+element_t *q_get(struct list_head *head, int i);
+
+/**
+ * q_delete_at() - Delete the element at a given position
+ * @head: header of queue
+ * @i: 0-based position counted from the head
+ *
+ * Like q_get(), this takes O(S) steps once the positional index is built, and
+ * keeps the index up to date in O(n / S) steps. In the unrolled layout, the
+ * elements of the same block are moved to close the gap.
+ *
+ * Return: true for success, false if queue is NULL or @i is out of range.
+ */
+bool q_delete_at(struct list_head *head, int i);
+
 /**
  * q_delete_dup() - Delete all nodes that have duplicate string,
  *                  leaving only distinct strings from the original queue.
@@ -155,6 +572,28 @@ bool q_delete_mid(struct list_head *head);
  */
 bool q_delete_dup(struct list_head *head);
 
+/**
+ * q_delete_dup_cmp() - Like q_delete_dup(), with strings compared by @cmp
+ * @head: header of queue
+ * @cmp: order the queue is sorted in, NULL for strcmp()
+ *
+ * Return: true for success, false if list is NULL or empty.
+ */
+bool q_delete_dup_cmp(struct list_head *head, q_cmp_t cmp);
+
+/**
+ * q_delete_dup_hash() - Delete all nodes whose string occurs more than once
+ * anywhere in the queue, leaving only distinct strings in their original order.
+ * @head: header of queue
+ *
+ * Unlike q_delete_dup(), the queue does not need to be sorted. Strings are
+ * looked up in a hash table, so the queue is traversed only once.
+ *
+ * Return: true for success, false if list is NULL or empty, or the hash table
+ * could not be allocated.
+ */
+bool q_delete_dup_hash(struct list_head *head);
+
 /**
  * q_swap() - Swap every two adjacent nodes
  * @head: header of queue
@@ -172,6 +611,9 @@ void q_swap(struct list_head *head);
  * This function should not allocate or free any list elements
  * (e.g., by calling q_insert_head, q_insert_tail, or q_remove_head).
  * It should rearrange the existing ones.
+ *
+ * Only the direction the list is read in is flipped, so this runs in
+ * constant time.
  */
 void q_reverse(struct list_head *head);
 
@@ -190,16 +632,58 @@ void q_reverse(struct list_head *head);
  */
 void q_reverseK(struct list_head *head, int k);
 
+/**
+ * q_shuffle() - Put the elements of queue in a uniformly random order
+ * @head: header of queue
+ * @nodes: room for q_size(head) node pointers, provided by the caller
+ * @state: state of the random_next() generator drawing the order
+ *
+ * This is a Fisher-Yates shuffle over a snapshot of the nodes taken in
+ * @nodes, so it takes linear time and allocates nothing.
+ *
+ * No effect if queue is NULL or has fewer than two elements.
+ */
+void q_shuffle(struct list_head *head,
+               struct list_head **nodes,
+               uintptr_t *state);
+
+/* Sorting engines q_sort() can use */
+enum {
+    SORT_MERGE, /* natural merge sort, the default */
+    SORT_RADIX, /* MSD radix sort, for large queues of short strings */
+};
+
+/* Engine used by q_sort() */
+extern int sort_algo;
+
+/* Maximum number of threads q_sort() may use on large queues */
+extern int sort_threads;
+
 /**
  * q_sort() - Sort elements of queue in ascending/descending order
  * @head: header of queue
  * @descend: whether or not to sort in descending order
  *
+ * The sort is stable with every engine selected by sort_algo, and for any
+ * number of threads.
+ *
  * No effect if queue is NULL or empty. If there has only one element, do
  * nothing.
  */
 void q_sort(struct list_head *head, bool descend);
 
+/**
+ * q_sort_cmp() - Like q_sort(), in the order given by @cmp
+ * @head: header of queue
+ * @cmp: order to sort in, NULL for strcmp()
+ * @descend: whether or not to sort in descending order
+ *
+ * The q_cmp_numeric() order is sorted on a 64-bit key parsed once from each
+ * value, by either engine. Radix sort knows no other order than strcmp(), so
+ * the remaining ones are always merge sorted.
+ */
+void q_sort_cmp(struct list_head *head, q_cmp_t cmp, bool descend);
+
 /**
  * q_ascend() - Remove every node which has a node with a strictly less
  * value anywhere to the right side of it.
@@ -216,6 +700,15 @@ void q_sort(struct list_head *head, bool descend);
  */
 int q_ascend(struct list_head *head);
 
+/**
+ * q_ascend_cmp() - Like q_ascend(), with values compared by @cmp
+ * @head: header of queue
+ * @cmp: order of values, NULL for strcmp()
+ *
+ * Return: the number of elements in queue after performing operation
+ */
+int q_ascend_cmp(struct list_head *head, q_cmp_t cmp);
+
 /**
  * q_descend() - Remove every node which has a node with a strictly greater
  * value anywhere to the right side of it.
@@ -232,6 +725,15 @@ int q_ascend(struct list_head *head);
  */
 int q_descend(struct list_head *head);
 
+/**
+ * q_descend_cmp() - Like q_descend(), with values compared by @cmp
+ * @head: header of queue
+ * @cmp: order of values, NULL for strcmp()
+ *
+ * Return: the number of elements in queue after performing operation
+ */
+int q_descend_cmp(struct list_head *head, q_cmp_t cmp);
+
 /**
  * q_merge() - Merge all the queues into one sorted queue, which is in
  * ascending/descending order.
@@ -252,4 +754,14 @@ int q_descend(struct list_head *head);
  */
 int q_merge(struct list_head *head, bool descend);
 
+/**
+ * q_merge_cmp() - Like q_merge(), for queues sorted in the order of @cmp
+ * @head: header of chain
+ * @cmp: order the queues are sorted in, NULL for strcmp()
+ * @descend: whether to merge queues sorted in descending order
+ *
+ * Return: the number of elements in queue after merging
+ */
+int q_merge_cmp(struct list_head *head, q_cmp_t cmp, bool descend);
+
 #endif /* LAB0_QUEUE_H */
@@ -0,0 +1,910 @@
+#include <ctype.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "queue_common.h"
+
+/* Notice: sometimes, Cppcheck would find the potential NULL pointer bugs,
+ * but some of them cannot occur. You can suppress them by adding the
+ * following line.
+ *   cppcheck-suppress nullPointer
+ */
+
+/* A slot whose element does not point at its own @str keeps one of these in
+ * @str[0], telling where the string came from.
+ */
+enum {
+    STR_OWNED = 1, /* handed over by the caller, freed with the element */
+    STR_INTERNED,  /* shared through the interning pool */
+};
+
+struct slab *slab_new(queue_t *owner, size_t cap)
+{
+    struct slab *slab = malloc(sizeof(struct slab) + cap);
+    if (slab) {
+        slab->owner = owner;
+        slab->used = 0;
+        slab->cap = cap;
+        slab->live = 0;
+    }
+    return slab;
+}
+
+void slab_retire(struct slab *slab)
+{
+    if (!slab)
+        return;
+    slab->owner = NULL;
+    if (!slab->live)
+        free(slab);
+}
+
+/* Make sure @q's slab has @need bytes left, starting a new one of at least
+ * @want bytes if not
+ */
+static struct slab *slab_reserve(queue_t *q, size_t need, size_t want)
+{
+    if (q->slab->used + need <= q->slab->cap)
+        return q->slab;
+
+    struct slab *slab = slab_new(q, want > SLAB_SIZE ? want : SLAB_SIZE);
+    if (slab) {
+        slab_retire(q->slab);
+        q->slab = slab;
+    }
+    return slab;
+}
+
+/* Take the next @need bytes of @slab, which must have room for them */
+static inline struct slot *slab_carve(struct slab *slab, size_t need)
+{
+    struct slot *slot = (struct slot *) (slab->data + slab->used);
+    slab->used += need;
+    slab->live++;
+    slot->slab = slab;
+    return slot;
+}
+
+/* Length of the optionally signed decimal integer @s with its sign skipped
+ * to @digits, or 0 if @s is not one
+ */
+static size_t __number(const char *s, const char **digits)
+{
+    if (*s == '-' || *s == '+')
+        s++;
+    *digits = s;
+    while (isdigit((unsigned char) *s))
+        s++;
+    return *s ? 0 : s - *digits;
+}
+
+int q_cmp_numeric(const char *a, const char *b)
+{
+    const char *da, *db;
+    size_t la = __number(a, &da), lb = __number(b, &db);
+    if (!la || !lb)
+        return la ? -1 : lb ? 1 : strcmp(a, b);
+
+    for (; la > 1 && *da == '0'; la--)
+        da++;
+    for (; lb > 1 && *db == '0'; lb--)
+        db++;
+    bool zero = la == 1 && *da == '0' && lb == 1 && *db == '0';
+    bool nega = *a == '-', negb = *b == '-';
+    if (zero)
+        return 0;
+    if (nega != negb)
+        return nega ? -1 : 1;
+
+    int mag = la != lb ? (la < lb ? -1 : 1) : strcmp(da, db);
+    return nega ? -mag : mag;
+}
+
+int q_cmp_nocase(const char *a, const char *b)
+{
+    return strcasecmp(a, b);
+}
+
+int q_cmp_length(const char *a, const char *b)
+{
+    size_t la = strlen(a), lb = strlen(b);
+    if (la != lb)
+        return la < lb ? -1 : 1;
+    return strcmp(a, b);
+}
+
+uint64_t __key_of(const char *s)
+{
+    const char *digits;
+    size_t len = __number(s, &digits);
+    if (!len)
+        return KEY_STRING | __prefix(s, strnlen(s, 7)) >> 8;
+
+    for (; len > 1 && *digits == '0'; len--)
+        digits++;
+    bool neg = *s == '-';
+    if (len > 18)
+        return neg ? 0 : KEY_HUGE;
+    uint64_t v = 0;
+    for (; *digits; digits++)
+        v = v * 10 + (*digits - '0');
+    if (v >= KEY_BIAS)
+        return neg ? 0 : KEY_HUGE;
+    return neg ? KEY_BIAS - v : KEY_BIAS + v;
+}
+
+int __numeric_keyed(const char *a, const char *b)
+{
+    return q_cmp_numeric(a, b);
+}
+
+/* Strings shared by the interned elements of all queues. An entry counts
+ * the elements referring to it and goes away with the last of them. The
+ * bucket array is dropped whenever the pool runs empty, so that nothing is
+ * left allocated once every queue has been freed.
+ */
+struct intern_entry {
+    struct intern_entry *next; /* next entry in the same bucket */
+    uint32_t hash;
+    int refs;
+    char str[];
+};
+
+static struct {
+    struct intern_entry **buckets;
+    size_t cap; /* number of buckets, a power of two */
+    size_t count;
+} pool;
+
+#define POOL_MIN 1024
+
+int intern_strings = 0;
+
+static void pool_drop(void)
+{
+    free(pool.buckets);
+    pool.buckets = NULL;
+    pool.cap = 0;
+}
+
+/* Double the number of buckets, keeping the chains short */
+static bool pool_grow(void)
+{
+    size_t cap = pool.cap ? pool.cap * 2 : POOL_MIN;
+    struct intern_entry **buckets = calloc(cap, sizeof(*buckets));
+    if (!buckets)
+        return false;
+
+    for (size_t i = 0; i < pool.cap; i++) {
+        struct intern_entry *e = pool.buckets[i], *next;
+        for (; e; e = next) {
+            next = e->next;
+            e->next = buckets[e->hash & (cap - 1)];
+            buckets[e->hash & (cap - 1)] = e;
+        }
+    }
+    free(pool.buckets);
+    pool.buckets = buckets;
+    pool.cap = cap;
+    return true;
+}
+
+/* Take a reference to the pooled copy of @s, which has @len characters */
+static char *__intern(const char *s, size_t len)
+{
+    uint32_t hash = __hash(s);
+    if (pool.cap) {
+        struct intern_entry *e = pool.buckets[hash & (pool.cap - 1)];
+        for (; e; e = e->next) {
+            if (e->hash == hash && !strcmp(e->str, s)) {
+                e->refs++;
+                return e->str;
+            }
+        }
+    }
+
+    /* Failing to grow only makes the chains longer */
+    if (pool.count >= pool.cap && !pool_grow() && !pool.cap)
+        return NULL;
+    struct intern_entry *e = malloc(sizeof(struct intern_entry) + len + 1);
+    if (!e) {
+        if (!pool.count)
+            pool_drop();
+        return NULL;
+    }
+    memcpy(e->str, s, len + 1);
+    e->hash = hash;
+    e->refs = 1;
+    e->next = pool.buckets[hash & (pool.cap - 1)];
+    pool.buckets[hash & (pool.cap - 1)] = e;
+    pool.count++;
+    return e->str;
+}
+
+/* Drop a reference taken by __intern() */
+static void __unintern(char *str)
+{
+    struct intern_entry *e =
+        (struct intern_entry *) (str - offsetof(struct intern_entry, str));
+    if (--e->refs)
+        return;
+
+    struct intern_entry **link = &pool.buckets[e->hash & (pool.cap - 1)];
+    while (*link != e)
+        link = &(*link)->next;
+    *link = e->next;
+    free(e);
+    if (!--pool.count)
+        pool_drop();
+}
+
+element_t *__element_new(queue_t *q,
+                         const char *s,
+                         size_t len,
+                         bool owned,
+                         size_t reserve)
+{
+    char *shared = NULL;
+    if (!owned && intern_strings && !(shared = __intern(s, len)))
+        return NULL;
+
+    /* Each slot counts as an allocation for the failures the harness
+     * injects, and a long string gets a slab of its own
+     */
+    size_t need = SLOT_SIZE(owned || shared ? 0 : len);
+    size_t want = reserve > need ? reserve : need;
+    struct slab *slab = NULL;
+    if (!test_alloc_fails())
+        slab = need > SLAB_LARGE ? slab_new(NULL, need)
+                                 : slab_reserve(q, need, want);
+    if (!slab) {
+        if (shared)
+            __unintern(shared);
+        return NULL;
+    }
+
+    struct slot *slot = slab_carve(slab, need);
+    element_t *e = &slot->elem;
+    if (owned) {
+        slot->str[0] = STR_OWNED;
+        e->value = (char *) s;
+    } else if (shared) {
+        slot->str[0] = STR_INTERNED;
+        e->value = shared;
+    } else {
+        e->value = memcpy(slot->str, s, len + 1);
+    }
+    e->prefix = __prefix(s, len);
+    return e;
+}
+
+/* Insert an element at head of queue */
+bool q_insert_head(struct list_head *head, char *s)
+{
+    return __q_insert(head, s, false, false);
+}
+
+/* Insert an element at tail of queue */
+bool q_insert_tail(struct list_head *head, char *s)
+{
+    return __q_insert(head, s, true, false);
+}
+
+/* Insert an element at head of queue, taking over the string */
+bool q_insert_head_owned(struct list_head *head, char *s)
+{
+    return __q_insert(head, s, false, true);
+}
+
+/* Insert an element at tail of queue, taking over the string */
+bool q_insert_tail_owned(struct list_head *head, char *s)
+{
+    return __q_insert(head, s, true, true);
+}
+
+/* Insert an array of strings at head of queue */
+bool q_insert_head_bulk(struct list_head *head, const char **strs, size_t n)
+{
+    return __q_insert_bulk(head, strs, NULL, n, false);
+}
+
+/* Insert an array of strings at tail of queue */
+bool q_insert_tail_bulk(struct list_head *head, const char **strs, size_t n)
+{
+    return __q_insert_bulk(head, strs, NULL, n, true);
+}
+
+/* Insert the strings packed in a buffer at head of queue */
+bool q_insert_head_buf(struct list_head *head, const char *buf, size_t n)
+{
+    return __q_insert_bulk(head, NULL, buf, n, false);
+}
+
+/* Insert the strings packed in a buffer at tail of queue */
+bool q_insert_tail_buf(struct list_head *head, const char *buf, size_t n)
+{
+    return __q_insert_bulk(head, NULL, buf, n, true);
+}
+
+/* Return number of elements in queue */
+int q_size(struct list_head *head)
+{
+    return head ? queue_of(head)->size : 0;
+}
+
+/* Delete the middle node in queue through the positional index */
+bool q_delete_mid_index(struct list_head *head)
+{
+    return q_delete_at(head, q_size(head) / 2);
+}
+
+/* Delete all nodes that have duplicate string */
+bool q_delete_dup(struct list_head *head)
+{
+    return q_delete_dup_cmp(head, NULL);
+}
+
+/* Swap every two adjacent nodes */
+void q_swap(struct list_head *head)
+{
+    q_reverseK(head, 2);
+}
+
+void q_release_element(element_t *e)
+{
+    struct slot *slot = container_of(e, struct slot, elem);
+    if (e->value != slot->str) {
+        if (slot->str[0] == STR_OWNED)
+            free(e->value);
+        else
+            __unintern(e->value);
+    }
+
+    struct slab *slab = slot->slab;
+    if (--slab->live)
+        return;
+    if (slab->owner)
+        slab->used = 0; /* Nothing alive, start over from the beginning */
+    else
+        free(slab);
+}
+
+/* Whether the element at @a may stay in front of the one at @b in the order
+ * given by @cmp
+ */
+static inline bool __in_order(struct list_head *a,
+                              struct list_head *b,
+                              bool descend,
+                              q_cmp_t cmp)
+{
+    int c = __compare(list_entry(a, element_t, list),
+                      list_entry(b, element_t, list), cmp);
+    return descend ? c >= 0 : c <= 0;
+}
+
+void __link_head(struct list_head *head, struct list_head *start)
+{
+    struct list_head *end = head;
+    head->next = start;
+    for (; start; end = start, start = start->next)
+        start->prev = end;
+    end->next = head;
+    head->prev = end;
+}
+
+/* Merge two NULL-terminated lists, leaving prev pointers untouched */
+static struct list_head *merge(struct list_head *a,
+                               struct list_head *b,
+                               bool descend,
+                               q_cmp_t cmp)
+{
+    struct list_head *head = NULL, **tail = &head;
+
+    for (;;) {
+        /* if equal, take 'a' -- important for sort stability */
+        if (__in_order(a, b, descend, cmp)) {
+            *tail = a;
+            tail = &a->next;
+            a = a->next;
+            if (!a) {
+                *tail = b;
+                break;
+            }
+        } else {
+            *tail = b;
+            tail = &b->next;
+            b = b->next;
+            if (!b) {
+                *tail = a;
+                break;
+            }
+        }
+    }
+    return head;
+}
+
+/* Merge two NULL-terminated lists into the empty queue @head, restoring the
+ * prev pointers and the circular structure on the way.
+ */
+static void merge_final(struct list_head *head,
+                        struct list_head *a,
+                        struct list_head *b,
+                        bool descend,
+                        q_cmp_t cmp)
+{
+    struct list_head *tail = head;
+
+    for (;;) {
+        if (__in_order(a, b, descend, cmp)) {
+            tail->next = a;
+            a->prev = tail;
+            tail = a;
+            a = a->next;
+            if (!a)
+                break;
+        } else {
+            tail->next = b;
+            b->prev = tail;
+            tail = b;
+            b = b->next;
+            if (!b) {
+                b = a;
+                break;
+            }
+        }
+    }
+
+    /* Finish linking remainder of list b on to tail */
+    tail->next = b;
+    do {
+        b->prev = tail;
+        tail = b;
+        b = b->next;
+    } while (b);
+
+    tail->next = head;
+    head->prev = tail;
+}
+
+/* Runs waiting to be merged keep the invariants of Timsort, so their lengths
+ * grow at least as fast as the Fibonacci numbers from the top of the stack
+ * down. 64 entries are more than enough for any int-sized queue.
+ */
+#define MAX_RUNS 64
+
+struct run {
+    struct list_head *head;
+    int len;
+};
+
+/* Cut the longest non-descending or strictly descending prefix off the
+ * NULL-terminated list @list, reversing it in the latter case. Reversing only
+ * strictly descending runs keeps equal elements in their original order.
+ */
+static struct run __find_run(struct list_head **list,
+                             bool descend,
+                             q_cmp_t cmp)
+{
+    struct run run = {.head = *list, .len = 1};
+    struct list_head *node = run.head->next;
+
+    if (!node || __in_order(run.head, node, descend, cmp)) {
+        struct list_head *tail = run.head;
+        while (node && __in_order(tail, node, descend, cmp)) {
+            tail = node;
+            node = node->next;
+            run.len++;
+        }
+        tail->next = NULL;
+    } else {
+        run.head->next = NULL;
+        while (node && !__in_order(run.head, node, descend, cmp)) {
+            struct list_head *next = node->next;
+            node->next = run.head;
+            run.head = node;
+            node = next;
+            run.len++;
+        }
+    }
+    *list = node;
+    return run;
+}
+
+/* Merge the i-th and (i+1)-th pending runs */
+static void __merge_at(struct run *runs,
+                       int *n,
+                       int i,
+                       bool descend,
+                       q_cmp_t cmp)
+{
+    runs[i].head = merge(runs[i].head, runs[i + 1].head, descend, cmp);
+    runs[i].len += runs[i + 1].len;
+    if (i == *n - 3)
+        runs[i + 1] = runs[i + 2];
+    (*n)--;
+}
+
+/* Split the NULL-terminated @list into natural runs and merge them until at
+ * most two are left in @runs. Return the number of runs left.
+ */
+static int __merge_runs(struct run *runs,
+                        struct list_head *list,
+                        bool descend,
+                        q_cmp_t cmp)
+{
+    int n = 0;
+
+    while (list) {
+        runs[n++] = __find_run(&list, descend, cmp);
+        while (n > 1) {
+            int i = n - 2;
+            if ((i > 0 && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+                (i > 1 && runs[i - 2].len <= runs[i - 1].len + runs[i].len)) {
+                if (runs[i - 1].len < runs[i + 1].len)
+                    i--;
+            } else if (runs[i].len > runs[i + 1].len) {
+                break;
+            }
+            __merge_at(runs, &n, i, descend, cmp);
+        }
+    }
+
+    while (n > 2)
+        __merge_at(runs, &n, n - 2, descend, cmp);
+    return n;
+}
+
+/* Merge sort the NULL-terminated @list, leaving prev pointers untouched */
+static struct list_head *__sort_list(struct list_head *list,
+                                     bool descend,
+                                     q_cmp_t cmp)
+{
+    struct run runs[MAX_RUNS];
+    if (__merge_runs(runs, list, descend, cmp) == 2)
+        return merge(runs[0].head, runs[1].head, descend, cmp);
+    return runs[0].head;
+}
+
+int sort_algo = SORT_MERGE;
+
+/* Buckets smaller than this, or nested deeper than this, are merge sorted */
+#define RADIX_CUTOFF 32
+#define RADIX_DEPTH 16
+
+/* Get the character of @e at @depth, which must not be past its end */
+static inline unsigned char __char_at(const element_t *e, size_t depth)
+{
+    if (depth < 8)
+        return (e->prefix >> (56 - 8 * depth)) & 0xff;
+    return e->value[depth];
+}
+
+/* MSD radix sort the @n elements of the NULL-terminated @list, whose values
+ * share their first @depth characters, or whose numeric keys share their
+ * first @depth bytes if @cmp is __numeric_keyed. The sorted elements are
+ * appended at @out, and the next pointer of the last one is returned for
+ * further appends. Elements are distributed in order, so equal values keep
+ * their order.
+ */
+static struct list_head **__radix_sort(struct list_head **out,
+                                       struct list_head *list,
+                                       int n,
+                                       size_t depth,
+                                       bool descend,
+                                       q_cmp_t cmp)
+{
+    if (n < RADIX_CUTOFF || depth >= (cmp ? 8 : RADIX_DEPTH)) {
+        *out = __sort_list(list, descend, cmp);
+        while (*out)
+            out = &(*out)->next;
+        return out;
+    }
+
+    struct list_head *heads[256], **tails[256];
+    int counts[256] = {0};
+    for (int c = 0; c < 256; c++)
+        tails[c] = &heads[c];
+
+    for (; list; list = list->next) {
+        unsigned char c = __char_at(list_entry(list, element_t, list), depth);
+        *tails[c] = list;
+        tails[c] = &list->next;
+        counts[c]++;
+    }
+
+    for (int i = 0; i < 256; i++) {
+        int c = descend ? 255 - i : i;
+        if (!counts[c])
+            continue;
+        *tails[c] = NULL;
+        if ((c == 0 && !cmp) || counts[c] == 1) {
+            /* Values ending here are all equal */
+            *out = heads[c];
+            out = tails[c];
+        } else {
+            out = __radix_sort(out, heads[c], counts[c], depth + 1, descend,
+                               cmp);
+        }
+    }
+    return out;
+}
+
+/* Whether radix sort knows the order of @cmp */
+static inline bool __radix_order(q_cmp_t cmp)
+{
+    return !cmp || cmp == __numeric_keyed;
+}
+
+/* Sort the @n elements of the NULL-terminated @list with the engine selected
+ * by sort_algo, leaving prev pointers untouched. Radix sort only knows the
+ * default order and numeric keys, so any other order is merge sorted.
+ */
+static struct list_head *__sort_segment(struct list_head *list,
+                                        int n,
+                                        bool descend,
+                                        q_cmp_t cmp)
+{
+    if (sort_algo == SORT_RADIX && __radix_order(cmp)) {
+        struct list_head *sorted = NULL;
+        *__radix_sort(&sorted, list, n, 0, descend, cmp) = NULL;
+        return sorted;
+    }
+    return __sort_list(list, descend, cmp);
+}
+
+int sort_threads = 1;
+
+/* Do not bother other threads with fewer elements than this each */
+#define PARALLEL_MIN 16384
+#define MAX_THREADS 64
+
+struct sort_task {
+    struct list_head *list, *other;
+    int n;
+    bool descend;
+    q_cmp_t cmp;
+};
+
+static void *__sort_worker(void *arg)
+{
+    struct sort_task *task = arg;
+    task->list = __sort_segment(task->list, task->n, task->descend, task->cmp);
+    return NULL;
+}
+
+static void *__merge_worker(void *arg)
+{
+    struct sort_task *task = arg;
+    task->list = merge(task->list, task->other, task->descend, task->cmp);
+    return NULL;
+}
+
+/* Run @fn on each of the @n tasks, the first one on the calling thread.
+ * Tasks for which no thread can be created are run on the calling thread too.
+ */
+static void __run_parallel(void *(*fn)(void *), struct sort_task *tasks, int n)
+{
+    pthread_t tids[MAX_THREADS];
+    int spawned = 1;
+
+    for (; spawned < n; spawned++) {
+        if (pthread_create(&tids[spawned], NULL, fn, &tasks[spawned]))
+            break;
+    }
+
+    fn(&tasks[0]);
+    for (int i = spawned; i < n; i++)
+        fn(&tasks[i]);
+    for (int i = 1; i < spawned; i++)
+        pthread_join(tids[i], NULL);
+}
+
+/* Sort the @n elements of the NULL-terminated @list into the empty queue
+ * @head using @threads threads. The list is cut into one segment per thread,
+ * the segments are sorted concurrently and then merged pairwise, again
+ * concurrently, until the last two are merged into @head.
+ *
+ * Signals are blocked meanwhile, and inherited as blocked by the workers. A
+ * time limit expiring in the middle is thus reported once all threads are
+ * done with the list, rather than jumping away while they still use it.
+ */
+static void __parallel_sort(struct list_head *head,
+                            struct list_head *list,
+                            int n,
+                            int threads,
+                            bool descend,
+                            q_cmp_t cmp)
+{
+    struct sort_task segs[MAX_THREADS], tasks[MAX_THREADS / 2];
+    sigset_t all, old;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    for (int i = 0; i < threads; i++) {
+        int len = n / threads + (i < n % threads);
+        segs[i] = (struct sort_task){
+            .list = list,
+            .n = len,
+            .descend = descend,
+            .cmp = cmp,
+        };
+        while (--len)
+            list = list->next;
+        struct list_head *next = list->next;
+        list->next = NULL;
+        list = next;
+    }
+    __run_parallel(__sort_worker, segs, threads);
+
+    while (threads > 2) {
+        int pairs = threads / 2;
+        for (int i = 0; i < pairs; i++) {
+            tasks[i] = (struct sort_task){
+                .list = segs[2 * i].list,
+                .other = segs[2 * i + 1].list,
+                .descend = descend,
+                .cmp = cmp,
+            };
+        }
+        __run_parallel(__merge_worker, tasks, pairs);
+        for (int i = 0; i < pairs; i++)
+            segs[i].list = tasks[i].list;
+        if (threads & 1)
+            segs[pairs] = segs[threads - 1];
+        threads = pairs + (threads & 1);
+    }
+    merge_final(head, segs[0].list, segs[1].list, descend, cmp);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+void __sort_into(struct list_head *head,
+                 struct list_head *list,
+                 int n,
+                 bool descend,
+                 q_cmp_t cmp)
+{
+    int threads = sort_threads < MAX_THREADS ? sort_threads : MAX_THREADS;
+    if (threads > n / PARALLEL_MIN)
+        threads = n / PARALLEL_MIN;
+
+    if (threads > 1) {
+        __parallel_sort(head, list, n, threads, descend, cmp);
+    } else if (sort_algo == SORT_RADIX && __radix_order(cmp)) {
+        __link_head(head, __sort_segment(list, n, descend, cmp));
+    } else {
+        struct run runs[MAX_RUNS];
+        if (__merge_runs(runs, list, descend, cmp) == 2)
+            merge_final(head, runs[0].head, runs[1].head, descend, cmp);
+        else
+            __link_head(head, runs[0].head);
+    }
+}
+
+/* Sort elements of queue in ascending/descending order.
+ *
+ * By default this is a bottom-up merge sort over the natural runs of the
+ * queue. The list is only walked forward and the prev pointers are rebuilt by
+ * the last merge, so an already sorted or reversed queue is handled in linear
+ * time. With sort_algo set to SORT_RADIX, an MSD radix sort is used instead.
+ * Large queues are sorted by up to sort_threads threads.
+ */
+void q_sort(struct list_head *head, bool descend)
+{
+    q_sort_cmp(head, NULL, descend);
+}
+
+/* Whether the head of list @i goes before the head of list @j. Exhausted
+ * lists lose every match, and ties go to the earlier list for stability.
+ */
+static inline bool __beats(const struct loser_tree *t, int i, int j)
+{
+    if (!t->cur[i])
+        return false;
+    if (!t->cur[j])
+        return true;
+    if (i < j)
+        return __in_order(t->cur[i], t->cur[j], t->descend, t->cmp);
+    return !__in_order(t->cur[j], t->cur[i], t->descend, t->cmp);
+}
+
+static void __tree_init(struct loser_tree *t)
+{
+    int winners[MERGE_WAYS];
+
+    for (int n = t->k - 1; n > 0; n--) {
+        int l = 2 * n, r = 2 * n + 1;
+        l = l >= t->k ? l - t->k : winners[l];
+        r = r >= t->k ? r - t->k : winners[r];
+        winners[n] = __beats(t, l, r) ? l : r;
+        t->losers[n] = winners[n] == l ? r : l;
+    }
+    t->losers[0] = t->k > 1 ? winners[1] : 0;
+}
+
+/* Take the next node off the winning list and replay its path to the root */
+static struct list_head *__tree_pop(struct loser_tree *t)
+{
+    int w = t->losers[0];
+    struct list_head *node = t->cur[w];
+    if (!node)
+        return NULL;
+
+    t->cur[w] = node->next;
+    for (int n = (w + t->k) / 2; n > 0; n /= 2) {
+        if (__beats(t, t->losers[n], w)) {
+            int tmp = t->losers[n];
+            t->losers[n] = w;
+            w = tmp;
+        }
+    }
+    t->losers[0] = w;
+    return node;
+}
+
+void __tree_merge(struct loser_tree *t, struct list_head *head)
+{
+    struct list_head *tail = head, *node;
+
+    __tree_init(t);
+    while ((node = __tree_pop(t))) {
+        tail->next = node;
+        node->prev = tail;
+        tail = node;
+    }
+    tail->next = head;
+    head->prev = tail;
+}
+
+void __tree_add(struct loser_tree *t, struct list_head *list)
+{
+    if (t->k == MERGE_WAYS) {
+        LIST_HEAD(partial);
+        __tree_merge(t, &partial);
+        partial.prev->next = NULL;
+        t->cur[0] = partial.next;
+        t->k = 1;
+    }
+    t->cur[t->k++] = list;
+}
+
+/* Remove every node which has a node with a strictly less value anywhere to
+ * the right side of it */
+int q_ascend(struct list_head *head)
+{
+    return __monotonic(head, false, NULL);
+}
+
+int q_ascend_cmp(struct list_head *head, q_cmp_t cmp)
+{
+    return __monotonic(head, false, cmp);
+}
+
+/* Remove every node which has a node with a strictly greater value anywhere to
+ * the right side of it */
+int q_descend(struct list_head *head)
+{
+    return __monotonic(head, true, NULL);
+}
+
+int q_descend_cmp(struct list_head *head, q_cmp_t cmp)
+{
+    return __monotonic(head, true, cmp);
+}
+
+/* Merge all the queues into one sorted queue, which is in ascending/descending
+ * order.
+ *
+ * The queues are merged at once through a loser tree, so each element is
+ * compared about log2(k) times and moved only once. Should the chain hold
+ * more than MERGE_WAYS queues, the ones gathered so far are merged into a
+ * single list which then takes part in the next round.
+ */
+int q_merge(struct list_head *head, bool descend)
+{
+    return q_merge_cmp(head, NULL, descend);
+}
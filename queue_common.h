@@ -0,0 +1,198 @@
+#ifndef LAB0_QUEUE_COMMON_H
+#define LAB0_QUEUE_COMMON_H
+
+/* Parts of the queue implementation shared by the backends: the storage of
+ * elements and their strings, the orders values are compared in, and the
+ * engines sorting and merging NULL-terminated chains of element list nodes.
+ * How the elements of a queue are held together is left to queue.c, or to
+ * queue_unrolled.c when built with QUEUE=unrolled.
+ */
+
+#include <string.h>
+
+#include "queue.h"
+
+/* Elements are not allocated one by one. Each queue bump-allocates slots,
+ * holding an element_t followed by its string, from a large slab obtained
+ * with a single malloc(). A slab counts the slots still alive and is freed
+ * once the count drops to zero and no queue is carving from it any more.
+ * Elements may outlive their queue (q_remove_*) or move to another queue
+ * (q_merge), so a slot keeps a pointer to its slab instead of its queue.
+ */
+#define SLAB_SIZE 16384
+
+/* Strings too long to share a slab get a dedicated one */
+#define SLAB_LARGE (SLAB_SIZE / 8)
+
+#define SLAB_ALIGN(n) (((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+struct slab {
+    queue_t *owner; /* NULL once no queue allocates from this slab */
+    size_t used, cap;
+    int live;
+    unsigned char data[];
+};
+
+struct slot {
+    struct slab *slab;
+    element_t elem;
+    char str[];
+};
+
+/* Bytes taken by a slot holding a string of @len characters */
+#define SLOT_SIZE(len) SLAB_ALIGN(sizeof(struct slot) + (len) + 1)
+
+/* Bulk insertions reserve slabs of up to this size. One block for a whole
+ * large batch would be filled in by the allocator and written again only
+ * after dropping out of the cache.
+ */
+#define BULK_SLAB (4 * SLAB_SIZE)
+
+struct slab *slab_new(queue_t *owner, size_t cap);
+
+/* Stop allocating from @slab, releasing it if nothing in it is alive */
+void slab_retire(struct slab *slab);
+
+/* Make an element holding @s, which has @len characters, carved out of the
+ * slab of @q. If @owned, the element keeps @s itself and frees it later.
+ * Otherwise it refers to the pooled copy of @s when intern_strings is set,
+ * and gets its own copy if not. A new slab, if one is needed, gets room for
+ * at least @reserve bytes. Return NULL if anything cannot be allocated.
+ */
+element_t *__element_new(queue_t *q,
+                         const char *s,
+                         size_t len,
+                         bool owned,
+                         size_t reserve);
+
+/* Pack the first 8 characters of @s, zero padded, in big-endian order */
+static inline uint64_t __prefix(const char *s, size_t len)
+{
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; i++) {
+        prefix <<= 8;
+        if (i < len)
+            prefix |= (unsigned char) s[i];
+    }
+    return prefix;
+}
+
+/* Compare two elements like strcmp() on their values */
+static inline int __cmp(const element_t *a, const element_t *b)
+{
+    if (a->prefix != b->prefix)
+        return a->prefix < b->prefix ? -1 : 1;
+    /* Both strings end within the prefix unless its last byte is set, and
+     * interned strings are equal exactly when they are the same copy.
+     */
+    if (!(a->prefix & 0xff) || a->value == b->value)
+        return 0;
+    return strcmp(a->value + 8, b->value + 8);
+}
+
+/* Numeric sort keys, ordered like q_cmp_numeric(). Integers of magnitude
+ * below KEY_BIAS map to their value offset by KEY_BIAS, which settles their
+ * order exactly. Larger ones map to 0 or KEY_HUGE, and other strings to
+ * KEY_STRING above their first 7 characters, so ties among those still need
+ * a look at the values.
+ */
+#define KEY_BIAS (1ULL << 61)
+#define KEY_HUGE (1ULL << 62)
+#define KEY_STRING (1ULL << 63)
+
+uint64_t __key_of(const char *s);
+
+/* Compare two elements whose prefixes hold their numeric keys */
+static inline int __cmp_key(const element_t *a, const element_t *b)
+{
+    if (a->prefix != b->prefix)
+        return a->prefix < b->prefix ? -1 : 1;
+    if (a->prefix && a->prefix < KEY_HUGE)
+        return 0;
+    return q_cmp_numeric(a->value, b->value);
+}
+
+/* Stands for q_cmp_numeric() once the keys are in place */
+int __numeric_keyed(const char *a, const char *b);
+
+/* The numeric key of @e if @keyed is set, or its prefix otherwise */
+static inline uint64_t __key(const element_t *e, bool keyed)
+{
+    return keyed ? __key_of(e->value)
+                 : __prefix(e->value, strnlen(e->value, 8));
+}
+
+/* Compare two elements with @cmp on their values, or like __cmp() if @cmp is
+ * NULL, so the default order costs no indirect call.
+ */
+static inline int __compare(const element_t *a,
+                            const element_t *b,
+                            q_cmp_t cmp)
+{
+    if (!cmp)
+        return __cmp(a, b);
+    if (cmp == __numeric_keyed)
+        return __cmp_key(a, b);
+    return cmp(a->value, b->value);
+}
+
+/* 32-bit FNV-1a hash of a string */
+static inline uint32_t __hash(const char *s)
+{
+    uint32_t hash = 2166136261u;
+    for (; *s; s++)
+        hash = (hash ^ (unsigned char) *s) * 16777619u;
+    return hash;
+}
+
+/* Link the NULL-terminated list @start into the empty queue @head, restoring
+ * the prev pointers on the way.
+ */
+void __link_head(struct list_head *head, struct list_head *start);
+
+/* Sort the @n elements of the NULL-terminated @list into the empty list
+ * @head, with the engine selected by sort_algo and up to sort_threads
+ * threads.
+ */
+void __sort_into(struct list_head *head,
+                 struct list_head *list,
+                 int n,
+                 bool descend,
+                 q_cmp_t cmp);
+
+/* q_merge() merges up to this many queues in one go */
+#define MERGE_WAYS 256
+
+/* Tournament tree over the lists being merged. Internal node n, for n in
+ * [1, k), remembers the list which lost the match played there, and node 0
+ * the overall winner. Leaf i sits at position k + i.
+ */
+struct loser_tree {
+    struct list_head *cur[MERGE_WAYS];
+    int losers[MERGE_WAYS];
+    int k;
+    bool descend;
+    q_cmp_t cmp;
+};
+
+/* Add the NULL-terminated @list to the lists merged by @t. Once @t is full,
+ * the lists gathered so far are merged into one, which takes part in the
+ * next round.
+ */
+void __tree_add(struct loser_tree *t, struct list_head *list);
+
+/* Merge the lists in @t into the empty list @head, linking every node into
+ * place exactly once.
+ */
+void __tree_merge(struct loser_tree *t, struct list_head *head);
+
+/* Hooks of the backends behind the operations in queue_common.c */
+bool __q_insert(struct list_head *head, char *s, bool tail, bool owned);
+bool __q_insert_bulk(struct list_head *head,
+                     const char **strs,
+                     const char *buf,
+                     size_t n,
+                     bool tail);
+int __monotonic(struct list_head *head, bool descend, q_cmp_t cmp);
+
+#endif /* LAB0_QUEUE_COMMON_H */
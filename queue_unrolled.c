@@ -0,0 +1,761 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "queue_common.h"
+#include "random.h"
+
+/* Notice: sometimes, Cppcheck would find the potential NULL pointer bugs,
+ * but some of them cannot occur. You can suppress them by adding the
+ * following line.
+ *   cppcheck-suppress nullPointer
+ */
+
+/* This is the queue built with QUEUE=unrolled. Elements are not linked to
+ * each other, but held in blocks of up to Q_BLOCK_LEN pointers, and only the
+ * blocks are linked into a ring through the queue head. Like in queue.c, the
+ * reversed flag tells whether the blocks run from the tail of the queue to
+ * its head.
+ *
+ * Operations which rearrange the elements without adding or removing any,
+ * such as q_sort() and q_merge(), put them back into the slots they were
+ * taken from, so they never allocate or free a block.
+ */
+
+#define BLOCK_OF(node) list_entry(node, struct q_block, link)
+
+/* Get a new block for @q, taking its spare block if it has one */
+static struct q_block *block_get(queue_t *q)
+{
+    struct q_block *b = q->spare;
+    if (b)
+        q->spare = NULL;
+    else
+        b = malloc(sizeof(struct q_block));
+    return b;
+}
+
+/* Unlink the empty block @b, keeping it as the spare block of @q unless that
+ * already has one
+ */
+static void block_put(queue_t *q, struct q_block *b)
+{
+    list_del(&b->link);
+    if (q->spare)
+        free(b);
+    else
+        q->spare = b;
+}
+
+/* Store @e in front of the first block of @ring, or behind its last block if
+ * @back. A block with no room left at that end has its elements moved to its
+ * middle if it is at most half full, and a new one is started otherwise. The
+ * first block of a queue starts in the middle too, so that pushing only at one
+ * end still leaves room at the other.
+ */
+static bool __push(queue_t *q, struct list_head *ring, element_t *e, bool back)
+{
+    struct q_block *b = NULL;
+    bool room = false;
+    if (!list_empty(ring)) {
+        b = back ? BLOCK_OF(ring->prev) : BLOCK_OF(ring->next);
+        room = back ? b->start + b->count < Q_BLOCK_LEN : b->start > 0;
+    }
+    if (b && !room && b->count <= Q_BLOCK_LEN / 2) {
+        int start = (Q_BLOCK_LEN - b->count) / 2;
+        memmove(&b->elems[start], &b->elems[b->start],
+                sizeof(element_t *) * b->count);
+        b->start = start;
+        room = true;
+    }
+    if (!room) {
+        b = block_get(q);
+        if (!b)
+            return false;
+        if (ring == &q->head && list_empty(ring))
+            b->start = Q_BLOCK_LEN / 2;
+        else
+            b->start = back ? 0 : Q_BLOCK_LEN;
+        b->count = 0;
+        if (back)
+            list_add_tail(&b->link, ring);
+        else
+            list_add(&b->link, ring);
+    }
+
+    if (back)
+        b->elems[b->start + b->count] = e;
+    else
+        b->elems[--b->start] = e;
+    b->count++;
+    return true;
+}
+
+/* Take the element off the front of the first block of @q, or off the back
+ * of its last block if @back, freeing the block once it is empty
+ */
+static element_t *__pop(queue_t *q, bool back)
+{
+    struct q_block *b = back ? BLOCK_OF(q->head.prev) : BLOCK_OF(q->head.next);
+    element_t *e = back ? b->elems[b->start + b->count - 1]
+                        : b->elems[b->start++];
+    if (!--b->count)
+        block_put(q, b);
+    return e;
+}
+
+/* Release the elements held by the blocks of @ring, and the blocks */
+static void __release_blocks(struct list_head *ring)
+{
+    struct q_block *b, *safe;
+    list_for_each_entry_safe (b, safe, ring, link) {
+        for (int j = b->start; j < b->start + b->count; j++)
+            q_release_element(b->elems[j]);
+        free(b);
+    }
+    INIT_LIST_HEAD(ring);
+}
+
+/* Find the block holding the element at position @i of @q in block order,
+ * which must be in range, skipping whole blocks from the nearer end. The
+ * index of the element in the elems of the block is stored in @at.
+ */
+static struct q_block *__seek(queue_t *q, int i, int *at)
+{
+    struct list_head *link;
+    struct q_block *b;
+
+    if (i < q->size / 2) {
+        for (link = q->head.next;; link = link->next) {
+            b = BLOCK_OF(link);
+            if (i < b->count)
+                break;
+            i -= b->count;
+        }
+        *at = b->start + i;
+    } else {
+        i = q->size - 1 - i;
+        for (link = q->head.prev;; link = link->prev) {
+            b = BLOCK_OF(link);
+            if (i < b->count)
+                break;
+            i -= b->count;
+        }
+        *at = b->start + b->count - 1 - i;
+    }
+    return b;
+}
+
+/* Once @b is down to a quarter of its capacity, move its elements into the
+ * following block if they fit there, so that deletions in the middle of the
+ * queue cannot leave it spread over many sparse blocks.
+ */
+static void __absorb(queue_t *q, struct q_block *b)
+{
+    if (b->count > Q_BLOCK_LEN / 4 || b->link.next == &q->head)
+        return;
+    struct q_block *next = BLOCK_OF(b->link.next);
+    if (b->count + next->count > Q_BLOCK_LEN)
+        return;
+
+    if (next->start < b->count) {
+        int start = Q_BLOCK_LEN - next->count;
+        memmove(&next->elems[start], &next->elems[next->start],
+                sizeof(element_t *) * next->count);
+        next->start = start;
+    }
+    next->start -= b->count;
+    memcpy(&next->elems[next->start], &b->elems[b->start],
+           sizeof(element_t *) * b->count);
+    next->count += b->count;
+    block_put(q, b);
+}
+
+/* Squeeze the slots set to NULL out of the blocks of @q, keeping the order of
+ * the other elements. They are packed from the first block on, and the blocks
+ * left over are freed.
+ */
+static void __compact(queue_t *q)
+{
+    struct q_block *to = BLOCK_OF(q->head.next), *b;
+    int w = 0;
+
+    /* Slots are never written ahead of the one being read */
+    list_for_each_entry (b, &q->head, link) {
+        for (int j = b->start; j < b->start + b->count; j++) {
+            element_t *e = b->elems[j];
+            if (!e)
+                continue;
+            if (w == Q_BLOCK_LEN) {
+                to->start = 0;
+                to->count = w;
+                to = BLOCK_OF(to->link.next);
+                w = 0;
+            }
+            to->elems[w++] = e;
+        }
+    }
+    to->start = 0;
+    to->count = w;
+
+    struct list_head *link = w ? to->link.next : &to->link;
+    while (link != &q->head) {
+        struct list_head *next = link->next;
+        block_put(q, BLOCK_OF(link));
+        link = next;
+    }
+}
+
+/* Put the blocks of @q, and the elements within each block, in the opposite
+ * order and clear its reversed flag
+ */
+static void __normalize(queue_t *q)
+{
+    if (!q->reversed)
+        return;
+    struct list_head *link = &q->head;
+    do {
+        struct list_head *next = link->next;
+        link->next = link->prev;
+        link->prev = next;
+        if (link != &q->head) {
+            struct q_block *b = BLOCK_OF(link);
+            element_t **lo = &b->elems[b->start];
+            element_t **hi = lo + b->count - 1;
+            for (; lo < hi; lo++, hi--) {
+                element_t *e = *lo;
+                *lo = *hi;
+                *hi = e;
+            }
+        }
+        link = next;
+    } while (link != &q->head);
+    q->reversed = false;
+}
+
+/* Chain the elements of @q up through their list nodes in block order, with
+ * their prefixes replaced by numeric keys if @keyed. Return the first node of
+ * the NULL-terminated chain.
+ */
+static struct list_head *__gather(queue_t *q, bool keyed)
+{
+    struct list_head *first = NULL, **tail = &first;
+    struct q_block *b;
+    list_for_each_entry (b, &q->head, link) {
+        for (int j = b->start; j < b->start + b->count; j++) {
+            element_t *e = b->elems[j];
+            if (keyed)
+                e->prefix = __key(e, true);
+            *tail = &e->list;
+            tail = &e->list.next;
+        }
+    }
+    *tail = NULL;
+    return first;
+}
+
+/* Store the elements linked into @list, which has exactly as many elements as
+ * the blocks of @q have slots, into those slots in block order. Their prefixes
+ * are put back if @keyed.
+ */
+static void __scatter(queue_t *q, struct list_head *list, bool keyed)
+{
+    struct list_head *node = list->next;
+    struct q_block *b;
+    list_for_each_entry (b, &q->head, link) {
+        for (int j = b->start; j < b->start + b->count; j++) {
+            element_t *e = list_entry(node, element_t, list);
+            if (keyed)
+                e->prefix = __key(e, false);
+            b->elems[j] = e;
+            node = node->next;
+        }
+    }
+}
+
+/* Create an empty queue */
+struct list_head *q_new()
+{
+    queue_t *q = malloc(sizeof(queue_t));
+    if (!q)
+        return NULL;
+    /* Set up the first slab and block right away, so that inserting into an
+     * empty queue costs the same as inserting into a non-empty one. Removing
+     * the last element keeps its block as the spare one for the same reason.
+     */
+    q->slab = slab_new(q, SLAB_SIZE);
+    q->spare = malloc(sizeof(struct q_block));
+    if (!q->slab || !q->spare) {
+        slab_retire(q->slab);
+        free(q->spare);
+        free(q);
+        return NULL;
+    }
+    INIT_LIST_HEAD(&q->head);
+    q->size = 0;
+    q->reversed = false;
+    return &q->head;
+}
+
+/* Free all storage used by queue */
+void q_free(struct list_head *head)
+{
+    if (head == NULL)
+        return;
+    __release_blocks(head);
+    slab_retire(queue_of(head)->slab);
+    free(queue_of(head)->spare);
+    free(queue_of(head));
+}
+
+/* Store a new element holding @s in @head, see __element_new() */
+bool __q_insert(struct list_head *head, char *s, bool tail, bool owned)
+{
+    if (head == NULL)
+        return false;
+    queue_t *q = queue_of(head);
+    element_t *new_node = __element_new(q, s, strlen(s), owned, 0);
+    if (!new_node)
+        return false;
+    if (!__push(q, head, new_node, tail != q->reversed)) {
+        q_release_element(new_node);
+        return false;
+    }
+    q->size++;
+    return true;
+}
+
+/* Insert @n strings, taken from @strs or else one after another from @buf.
+ *
+ * Like in queue.c, the space for the batch is sized up front. The new
+ * elements are stored in blocks of their own, which are then spliced into
+ * the queue, so either all of them are inserted or none is.
+ */
+bool __q_insert_bulk(struct list_head *head,
+                     const char **strs,
+                     const char *buf,
+                     size_t n,
+                     bool tail)
+{
+    if (head == NULL || (strs == NULL && buf == NULL))
+        return false;
+    if (n == 0)
+        return true;
+
+    size_t left = 0;
+    const char *s = buf;
+    for (size_t i = 0; i < n; i++) {
+        const char *str = strs ? strs[i] : s;
+        size_t len = strlen(str);
+        left += SLOT_SIZE(intern_strings ? 0 : len);
+        s = str + len + 1;
+    }
+
+    queue_t *q = queue_of(head);
+    bool at_tail = tail != q->reversed;
+    LIST_HEAD(batch);
+    s = buf;
+    size_t i = 0;
+    for (; i < n; i++) {
+        const char *str = strs ? strs[i] : s;
+        size_t len = strlen(str);
+        element_t *new_node = __element_new(
+            q, str, len, false, left < BULK_SLAB ? left : BULK_SLAB);
+        if (!new_node)
+            break;
+        if (!__push(q, &batch, new_node, at_tail)) {
+            q_release_element(new_node);
+            break;
+        }
+        left -= SLOT_SIZE(intern_strings ? 0 : len);
+        s = str + len + 1;
+    }
+
+    if (i < n) {
+        __release_blocks(&batch);
+        return false;
+    }
+
+    if (at_tail)
+        list_splice_tail(&batch, head);
+    else
+        list_splice(&batch, head);
+    q->size += n;
+    return true;
+}
+
+static element_t *__remove(struct list_head *head,
+                           char *sp,
+                           size_t bufsize,
+                           bool tail)
+{
+    if (head == NULL || list_empty(head))
+        return NULL;
+    queue_t *q = queue_of(head);
+    element_t *target = __pop(q, tail != q->reversed);
+    q->size--;
+    if (sp) {
+        strncpy(sp, target->value, bufsize - 1);
+        sp[bufsize - 1] = '\0';
+    }
+    return target;
+}
+
+/* Remove an element from head of queue */
+element_t *q_remove_head(struct list_head *head, char *sp, size_t bufsize)
+{
+    return __remove(head, sp, bufsize, false);
+}
+
+/* Remove an element from tail of queue */
+element_t *q_remove_tail(struct list_head *head, char *sp, size_t bufsize)
+{
+    return __remove(head, sp, bufsize, true);
+}
+
+/* Delete the middle node in queue, which is found by skipping whole blocks */
+bool q_delete_mid(struct list_head *head)
+{
+    return q_delete_at(head, q_size(head) / 2);
+}
+
+/* Get the element at position i */
+element_t *q_get(struct list_head *head, int i)
+{
+    if (head == NULL || i < 0 || i >= q_size(head))
+        return NULL;
+    queue_t *q = queue_of(head);
+    if (q->reversed)
+        i = q->size - 1 - i;
+    int at;
+    struct q_block *b = __seek(q, i, &at);
+    return b->elems[at];
+}
+
+/* Delete the element at position i, closing the gap from the shorter side of
+ * its block
+ */
+bool q_delete_at(struct list_head *head, int i)
+{
+    if (head == NULL || i < 0 || i >= q_size(head))
+        return false;
+
+    queue_t *q = queue_of(head);
+    if (q->reversed)
+        i = q->size - 1 - i;
+    int at;
+    struct q_block *b = __seek(q, i, &at);
+    element_t *e = b->elems[at];
+
+    int before = at - b->start, after = b->count - 1 - before;
+    if (before < after) {
+        memmove(&b->elems[b->start + 1], &b->elems[b->start],
+                sizeof(element_t *) * before);
+        b->start++;
+    } else {
+        memmove(&b->elems[at], &b->elems[at + 1], sizeof(element_t *) * after);
+    }
+    if (--b->count)
+        __absorb(q, b);
+    else
+        block_put(q, b);
+    q->size--;
+    q_release_element(e);
+    return true;
+}
+
+/* Delete all nodes whose string @cmp finds equal to a neighbour's */
+bool q_delete_dup_cmp(struct list_head *head, q_cmp_t cmp)
+{
+    if (head == NULL || list_empty(head))
+        return false;
+    queue_t *q = queue_of(head);
+    if (q->size == 1)
+        return true;
+
+    /* Each element is compared to the one before it in block order, which
+     * is kept until then, and deleted slots are squeezed out afterwards.
+     */
+    element_t **last = NULL;
+    bool last_dup = false;
+    struct q_block *b;
+    list_for_each_entry (b, head, link) {
+        for (int j = b->start; j < b->start + b->count; j++) {
+            element_t **slot = &b->elems[j];
+            bool dup = last && __compare(*slot, *last, cmp) == 0;
+            if (dup || last_dup) {
+                q_release_element(*last);
+                *last = NULL;
+                q->size--;
+            }
+            last = slot;
+            last_dup = dup;
+        }
+    }
+    if (last_dup) {
+        q_release_element(*last);
+        *last = NULL;
+        q->size--;
+    }
+    __compact(q);
+    return true;
+}
+
+/* Entry of the open addressing table used by q_delete_dup_hash() */
+struct dup_entry {
+    element_t **first; /* slot of the first element seen with this value */
+    element_t *elem;   /* the element itself, even once its slot is NULL */
+    uint32_t hash;
+    bool dup; /* @elem has been taken out as a duplicate */
+};
+
+/* Delete all nodes whose string occurs more than once, in any order */
+bool q_delete_dup_hash(struct list_head *head)
+{
+    if (head == NULL || list_empty(head))
+        return false;
+    queue_t *q = queue_of(head);
+    if (q->size == 1)
+        return true;
+
+    size_t cap = 1;
+    while (cap < (size_t) q->size * 2)
+        cap <<= 1;
+    struct dup_entry *table = calloc(cap, sizeof(struct dup_entry));
+    if (!table)
+        return false;
+
+    /* First occurrences of duplicated strings are only released at the end,
+     * so that later occurrences can still be compared against them.
+     */
+    struct q_block *b;
+    list_for_each_entry (b, head, link) {
+        for (int j = b->start; j < b->start + b->count; j++) {
+            element_t *entry = b->elems[j];
+            uint32_t hash = __hash(entry->value);
+            size_t i = hash & (cap - 1);
+            for (; table[i].first; i = (i + 1) & (cap - 1)) {
+                if (table[i].hash == hash && !__cmp(table[i].elem, entry))
+                    break;
+            }
+
+            if (!table[i].first) {
+                table[i].first = &b->elems[j];
+                table[i].elem = entry;
+                table[i].hash = hash;
+                continue;
+            }
+            if (!table[i].dup) {
+                *table[i].first = NULL;
+                table[i].dup = true;
+                q->size--;
+            }
+            b->elems[j] = NULL;
+            q_release_element(entry);
+            q->size--;
+        }
+    }
+
+    for (size_t i = 0; i < cap; i++) {
+        if (table[i].dup)
+            q_release_element(table[i].elem);
+    }
+    free(table);
+    __compact(q);
+    return true;
+}
+
+/* Reverse elements in queue */
+void q_reverse(struct list_head *head)
+{
+    if (head == NULL || q_size(head) < 2)
+        return;
+    queue_of(head)->reversed = !queue_of(head)->reversed;
+}
+
+/* Reverse the nodes of the list k at a time
+ *
+ * Each full group is reversed in place by swapping its elements from both
+ * ends inwards. A short last group is left as it is.
+ */
+void q_reverseK(struct list_head *head, int k)
+{
+    if (head == NULL || q_size(head) < 2 || k < 2)
+        return;
+
+    q_iter_t front;
+    element_t *e = q_iter_first(&front, head);
+    while (e) {
+        q_iter_t back = front;
+        int n = 1;
+        while (n < k && q_iter_next(&back))
+            n++;
+        if (n < k)
+            break;
+
+        q_iter_t next = back;
+        e = q_iter_next(&next);
+        for (int i = 0; i < k / 2; i++) {
+            element_t *tmp = front.block->elems[front.i];
+            front.block->elems[front.i] = back.block->elems[back.i];
+            back.block->elems[back.i] = tmp;
+            q_iter_next(&front);
+            q_iter_prev(&back);
+        }
+        front = next;
+    }
+}
+
+/* Shuffle the elements of the queue with Fisher-Yates over a snapshot of
+ * them, then put them back into the same slots in the new order.
+ */
+void q_shuffle(struct list_head *head,
+               struct list_head **nodes,
+               uintptr_t *state)
+{
+    int size = q_size(head);
+    if (size < 2)
+        return;
+
+    struct q_block *b;
+    int n = 0;
+    list_for_each_entry (b, head, link) {
+        for (int j = b->start; j < b->start + b->count; j++)
+            nodes[n++] = &b->elems[j]->list;
+    }
+
+    for (int i = size - 1; i > 0; i--) {
+        int j = random_next(state) % (i + 1);
+        struct list_head *node = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = node;
+    }
+
+    n = 0;
+    list_for_each_entry (b, head, link) {
+        for (int j = b->start; j < b->start + b->count; j++)
+            b->elems[j] = list_entry(nodes[n++], element_t, list);
+    }
+}
+
+/* Sort elements of queue in the order given by @cmp. The elements are chained
+ * up through their list nodes, sorted by the same engines as in queue.c, and
+ * stored back into the slots they came from.
+ */
+void q_sort_cmp(struct list_head *head, q_cmp_t cmp, bool descend)
+{
+    if (head == NULL || q_size(head) < 2)
+        return;
+
+    queue_t *q = queue_of(head);
+    bool keyed = cmp == q_cmp_numeric;
+    if (keyed)
+        cmp = __numeric_keyed;
+
+    /* Sorting the blocks the other way round and keeping the queue reversed
+     * gives the requested order, and leaves equal elements in queue order.
+     */
+    descend ^= q->reversed;
+    LIST_HEAD(sorted);
+    __sort_into(&sorted, __gather(q, keyed), q->size, descend, cmp);
+    __scatter(q, &sorted, keyed);
+}
+
+int __monotonic(struct list_head *head, bool descend, q_cmp_t cmp)
+{
+    if (head == NULL || list_empty(head))
+        return 0;
+    queue_t *q = queue_of(head);
+    if (q->size == 1)
+        return 1;
+
+    /* Walk from the tail of the queue towards its head, emptying the slots
+     * of the elements removed, and squeeze them out at the end.
+     */
+    q_iter_t it;
+    const element_t *last = q_iter_last(&it, head);
+    int count = 1;
+    for (element_t *e = q_iter_prev(&it); e; e = q_iter_prev(&it)) {
+        int c = __compare(e, last, cmp);
+        if (!c || (c < 0) != descend) {
+            last = e;
+            count++;
+        } else {
+            it.block->elems[it.i] = NULL;
+            q_release_element(e);
+        }
+    }
+    q->size = count;
+    __compact(q);
+    return count;
+}
+
+/* Merge all the queues, sorted in the order given by @cmp, into one.
+ *
+ * The elements of each queue are chained up and merged through the loser
+ * tree as in queue.c. The blocks of the other queues are moved over to the
+ * first one, which then has a slot for each merged element.
+ */
+int q_merge_cmp(struct list_head *head, q_cmp_t cmp, bool descend)
+{
+    if (head == NULL || list_empty(head))
+        return 0;
+
+    struct list_head *q_head = list_first_entry(head, queue_contex_t, chain)->q;
+    if (!q_head)
+        return 0;
+
+    bool keyed = cmp == q_cmp_numeric;
+    if (keyed)
+        cmp = __numeric_keyed;
+
+    struct loser_tree t = {.k = 0, .descend = descend, .cmp = cmp};
+    queue_contex_t *chain_entry = NULL;
+    int cnt = 0;
+
+    list_for_each_entry (chain_entry, head, chain) {
+        struct list_head *q = chain_entry->q;
+        if (!q || list_empty(q))
+            continue;
+        __normalize(queue_of(q));
+        __tree_add(&t, __gather(queue_of(q), keyed));
+        cnt += queue_of(q)->size;
+        if (q == q_head)
+            continue;
+        list_splice_tail_init(q, q_head);
+        queue_of(q)->size = 0;
+    }
+
+    if (t.k) {
+        LIST_HEAD(merged);
+        __tree_merge(&t, &merged);
+        __scatter(queue_of(q_head), &merged, keyed);
+    }
+    queue_of(q_head)->size = cnt;
+    queue_of(q_head)->reversed = false;
+
+    return cnt;
+}
+
+/* Check that every block is the prev of its successor, like queue.c does for
+ * nodes, and that each one holds between 1 and Q_BLOCK_LEN elements. The
+ * elements are counted into @len.
+ */
+bool q_check(struct list_head *head, int *len)
+{
+    struct list_head *cur = head;
+    int n = 0;
+    for (;;) {
+        struct list_head *next = cur->next;
+        if (!next || next->prev != cur)
+            return false;
+        cur = next;
+        if (cur == head)
+            break;
+        const struct q_block *b = BLOCK_OF(cur);
+        if (b->count < 1 || b->start < 0 || b->start + b->count > Q_BLOCK_LEN)
+            return false;
+        n += b->count;
+    }
+    *len = n;
+    return true;
+}
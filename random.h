@@ -48,4 +48,15 @@ static inline uintptr_t random_shuffle(uintptr_t x)
     return x;
 }
 
+/* Advance the splitmix generator @state and return its next output */
+static inline uintptr_t random_next(uintptr_t *state)
+{
+#if M_INTPTR_SIZE == 8
+    *state += 0x9e3779b97f4a7c15UL;
+#elif M_INTPTR_SIZE == 4
+    *state += 0x9e3779b9UL;
+#endif
+    return random_shuffle(*state);
+}
+
 #endif
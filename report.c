@@ -1,5 +1,7 @@
+#include <pthread.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -298,6 +300,167 @@ void free_string(char *s)
     free_block((void *) s, strlen(s) + 1);
 }
 
+/* Allocation profile. Blocks allocated while a command runs are charged to
+ * it, and so are the blocks it frees. Peak is the most live payload bytes
+ * seen while the command ran. Allocations may be cut short by an exception,
+ * so they only update counters atomically and never take the lock, which
+ * guards the list of commands.
+ */
+#define MAX_SITES 64
+#define N_SIZE_BUCKETS 24
+
+struct alloc_site {
+    const char *name;
+    atomic_size_t allocs, alloc_bytes;
+    atomic_size_t frees, free_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t latency_ns, max_latency_ns;
+};
+
+int mem_profile = 0;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct alloc_site sites[MAX_SITES] = {{.name = "(startup)"}};
+static int site_cnt = 1;
+static struct alloc_site *_Atomic cur_site = &sites[0];
+static atomic_size_t live_bytes = 0;
+static atomic_size_t live_peak_bytes = 0;
+
+/* Bucket i counts sizes above 2^(i-1) and up to 2^i, the last one the rest */
+static atomic_size_t size_hist[N_SIZE_BUCKETS];
+
+static void atomic_max(atomic_size_t *p, size_t v)
+{
+    size_t cur = atomic_load(p);
+    while (cur < v && !atomic_compare_exchange_weak(p, &cur, v))
+        ;
+}
+
+void profile_command(const char *name)
+{
+    if (!mem_profile)
+        return;
+
+    pthread_mutex_lock(&profile_lock);
+    int i = 0;
+    while (i < site_cnt && strcmp(sites[i].name, name))
+        i++;
+    if (i == site_cnt && site_cnt < MAX_SITES)
+        sites[site_cnt++].name = name;
+    if (i < site_cnt) {
+        cur_site = &sites[i];
+        atomic_max(&sites[i].peak_bytes, live_bytes);
+    }
+    pthread_mutex_unlock(&profile_lock);
+}
+
+void profile_alloc(size_t bytes, size_t ns)
+{
+    int b = 0;
+    while (b < N_SIZE_BUCKETS - 1 && ((size_t) 1 << b) < bytes)
+        b++;
+    size_hist[b]++;
+
+    size_t live = atomic_fetch_add(&live_bytes, bytes) + bytes;
+    atomic_max(&live_peak_bytes, live);
+
+    struct alloc_site *site = cur_site;
+    site->allocs++;
+    site->alloc_bytes += bytes;
+    atomic_max(&site->peak_bytes, live);
+    site->latency_ns += ns;
+    atomic_max(&site->max_latency_ns, ns);
+}
+
+void profile_free(size_t bytes)
+{
+    /* Blocks allocated before profiling was enabled are not accounted */
+    size_t live = atomic_load(&live_bytes);
+    while (!atomic_compare_exchange_weak(&live_bytes, &live,
+                                         live > bytes ? live - bytes : 0))
+        ;
+
+    struct alloc_site *site = cur_site;
+    site->frees++;
+    site->free_bytes += bytes;
+}
+
+void profile_show()
+{
+    pthread_mutex_lock(&profile_lock);
+    report(1, "Allocation profile: %lu bytes live, peak %lu bytes",
+           live_bytes, live_peak_bytes);
+    report(1, "  %-12s%10s%12s%10s%12s%12s%8s%10s", "Command", "Allocs",
+           "Bytes", "Frees", "Bytes", "Peak", "Avg ns", "Max ns");
+    for (int i = 0; i < site_cnt; i++) {
+        const struct alloc_site *site = &sites[i];
+        if (!site->allocs && !site->frees)
+            continue;
+        size_t allocs = site->allocs;
+        report(1, "  %-12s%10lu%12lu%10lu%12lu%12lu%8lu%10lu", site->name,
+               allocs, site->alloc_bytes, site->frees, site->free_bytes,
+               site->peak_bytes, allocs ? site->latency_ns / allocs : 0,
+               site->max_latency_ns);
+    }
+
+    report(1, "Allocation sizes:");
+    for (int b = 0; b < N_SIZE_BUCKETS; b++) {
+        if (!size_hist[b])
+            continue;
+        if (b < N_SIZE_BUCKETS - 1)
+            report(1, "  <= %-10lu%10lu", (size_t) 1 << b, size_hist[b]);
+        else
+            report(1, "  >  %-10lu%10lu", (size_t) 1 << (b - 1),
+                   size_hist[b]);
+    }
+
+    report(1, "Console: %lu allocations, peak %lu bytes", allocate_cnt,
+           peak_bytes);
+    pthread_mutex_unlock(&profile_lock);
+}
+
+bool profile_dump(const char *file_name)
+{
+    FILE *f = fopen(file_name, "w");
+    if (!f)
+        return false;
+
+    pthread_mutex_lock(&profile_lock);
+    fprintf(f, "{\n  \"live_bytes\": %lu,\n  \"peak_bytes\": %lu,\n",
+            live_bytes, live_peak_bytes);
+    fprintf(f, "  \"commands\": [");
+    bool first = true;
+    for (int i = 0; i < site_cnt; i++) {
+        const struct alloc_site *site = &sites[i];
+        if (!site->allocs && !site->frees)
+            continue;
+        fprintf(f,
+                "%s\n    {\"name\": \"%s\", \"allocs\": %lu, "
+                "\"alloc_bytes\": %lu, \"frees\": %lu, \"free_bytes\": %lu, "
+                "\"peak_bytes\": %lu, \"latency_ns\": %lu, "
+                "\"max_latency_ns\": %lu}",
+                first ? "" : ",", site->name, site->allocs, site->alloc_bytes,
+                site->frees, site->free_bytes, site->peak_bytes,
+                site->latency_ns, site->max_latency_ns);
+        first = false;
+    }
+    fprintf(f, "\n  ],\n  \"sizes\": [");
+    first = true;
+    for (int b = 0; b < N_SIZE_BUCKETS; b++) {
+        if (!size_hist[b])
+            continue;
+        /* Upper bound of the last bucket is unknown */
+        fprintf(f, "%s\n    {\"max\": %ld, \"count\": %lu}",
+                first ? "" : ",",
+                b < N_SIZE_BUCKETS - 1 ? (long) 1 << b : -1L, size_hist[b]);
+        first = false;
+    }
+    fprintf(f, "\n  ]\n}\n");
+    pthread_mutex_unlock(&profile_lock);
+
+    return !fclose(f);
+}
+
 /* Initialization of timers */
 void init_time(double *timep)
 {
@@ -44,6 +44,26 @@ void free_array(void *b, size_t cnt, size_t bytes);
 /* Free string saved by strsave_or_fail */
 void free_string(char *s);
 
+/* Allocation profiling of the test harness, enabled when nonzero */
+extern int mem_profile;
+
+/* Attribute subsequent allocations to command @name, a string that stays
+ * valid for the life of the program
+ */
+void profile_command(const char *name);
+
+/* Record an allocation of @bytes which took @ns nanoseconds */
+void profile_alloc(size_t bytes, size_t ns);
+
+/* Record release of a block of @bytes */
+void profile_free(size_t bytes);
+
+/* Print allocation profile */
+void profile_show();
+
+/* Write allocation profile to @file_name in JSON */
+bool profile_dump(const char *file_name);
+
 /* Time counted as fp number in seconds */
 void init_time(double *timep);
 
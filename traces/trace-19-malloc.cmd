@@ -0,0 +1,35 @@
+# Test of malloc failure on single insertions carved from a slab
+option fail 30
+option malloc 0
+new
+option malloc 25
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+ih gerbil
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+it jaguar
+option own 1
+it meerkat
+it meerkat
+it meerkat
+it meerkat
+it meerkat
+option own 0
+option malloc 0
+free
+quit
@@ -0,0 +1,35 @@
+# Test of the radix sort engine on large, reversed and duplicate-heavy queues
+option fail 0
+option malloc 0
+option sortalgo 1
+new
+ih RAND 20000
+it dolphin 50
+ih dolphin 50
+sort
+reverse
+sort
+option descend 1
+sort
+reverse
+sort
+option descend 0
+new
+it aardvark_bear_dolphin_gerbil_jaguar 40
+ih aardvark_bear_dolphin_gerbil_jaguar_meerkat 40
+it aardvark_bear_dolphin_gerbil_jaguar 40
+sort
+option descend 1
+sort
+option descend 0
+free
+free
+option sortalgo 0
+new
+ih RAND 5000
+reverse
+sort
+reverse
+sort
+free
+quit
@@ -0,0 +1,21 @@
+# Test of sorting large queues with several threads
+option fail 0
+option malloc 0
+option threads 4
+new
+ih RAND 70000
+it gerbil 200
+ih gerbil 200
+sort
+reverse
+sort
+option descend 1
+sort
+option sortalgo 1
+sort
+option descend 0
+sort
+option sortalgo 0
+option threads 1
+free
+quit
@@ -0,0 +1,2061 @@
+# Test of merging more queues than the loser tree merges at once
+option fail 0
+option malloc 0
+new
+it dolphin
+it panda
+sort
+new
+it aardvark
+it bear
+it vulture
+it bear
+it meerkat
+sort
+new
+it aardvark
+it vulture
+it gerbil
+it aardvark
+sort
+new
+sort
+new
+it panda
+it bear
+it gerbil
+sort
+new
+sort
+new
+it panda
+it aardvark
+it wolf
+it bear
+sort
+new
+it wolf
+sort
+new
+sort
+new
+it wolf
+it panda
+it aardvark
+it gerbil
+sort
+new
+sort
+new
+it dolphin
+it jaguar
+it panda
+it dolphin
+sort
+new
+it bear
+it wolf
+it jaguar
+it vulture
+sort
+new
+it dolphin
+it bear
+it wolf
+it wolf
+it gerbil
+sort
+new
+it bear
+it vulture
+sort
+new
+it bear
+it wolf
+it aardvark
+it wolf
+it gerbil
+sort
+new
+it vulture
+it panda
+it meerkat
+sort
+new
+it wolf
+it squirrel
+it meerkat
+sort
+new
+it gerbil
+it dolphin
+sort
+new
+it gerbil
+it bear
+it wolf
+it jaguar
+it vulture
+sort
+new
+it meerkat
+it squirrel
+it jaguar
+sort
+new
+it bear
+it bear
+it vulture
+it panda
+sort
+new
+it meerkat
+sort
+new
+it squirrel
+sort
+new
+it aardvark
+it bear
+it vulture
+sort
+new
+it meerkat
+it meerkat
+it meerkat
+it wolf
+sort
+new
+it wolf
+it squirrel
+it bear
+sort
+new
+sort
+new
+it squirrel
+it bear
+sort
+new
+sort
+new
+it jaguar
+it wolf
+it squirrel
+it jaguar
+it panda
+sort
+new
+it meerkat
+it aardvark
+it squirrel
+it meerkat
+it dolphin
+sort
+new
+it bear
+it squirrel
+it aardvark
+it gerbil
+sort
+new
+it dolphin
+it gerbil
+sort
+new
+it panda
+it squirrel
+it bear
+sort
+new
+it squirrel
+sort
+new
+it vulture
+it jaguar
+it dolphin
+sort
+new
+it vulture
+it jaguar
+it panda
+sort
+new
+it panda
+it gerbil
+sort
+new
+it bear
+sort
+new
+it dolphin
+sort
+new
+it gerbil
+sort
+new
+sort
+new
+it wolf
+it dolphin
+it jaguar
+sort
+new
+it aardvark
+it dolphin
+sort
+new
+it vulture
+it meerkat
+it wolf
+sort
+new
+it meerkat
+it dolphin
+it vulture
+it wolf
+sort
+new
+it aardvark
+it squirrel
+it vulture
+it panda
+it panda
+sort
+new
+it panda
+it bear
+it squirrel
+sort
+new
+it panda
+it aardvark
+it gerbil
+it bear
+it gerbil
+sort
+new
+it dolphin
+it bear
+it meerkat
+sort
+new
+it aardvark
+it bear
+it aardvark
+it wolf
+sort
+new
+it vulture
+sort
+new
+sort
+new
+it wolf
+it aardvark
+sort
+new
+sort
+new
+it wolf
+sort
+new
+it dolphin
+it jaguar
+it meerkat
+sort
+new
+it meerkat
+it squirrel
+it bear
+it bear
+sort
+new
+it squirrel
+it squirrel
+it squirrel
+sort
+new
+it bear
+it dolphin
+sort
+new
+sort
+new
+it meerkat
+it jaguar
+it squirrel
+it dolphin
+it vulture
+sort
+new
+sort
+new
+it vulture
+sort
+new
+it dolphin
+it vulture
+sort
+new
+sort
+new
+it jaguar
+it bear
+it jaguar
+it vulture
+sort
+new
+it dolphin
+it meerkat
+sort
+new
+it vulture
+sort
+new
+it vulture
+it meerkat
+it gerbil
+it wolf
+sort
+new
+it gerbil
+sort
+new
+it gerbil
+it gerbil
+it vulture
+sort
+new
+it meerkat
+it aardvark
+it aardvark
+sort
+new
+it squirrel
+it jaguar
+sort
+new
+it wolf
+sort
+new
+it squirrel
+it meerkat
+sort
+new
+it bear
+it gerbil
+sort
+new
+sort
+new
+it squirrel
+sort
+new
+it meerkat
+sort
+new
+it squirrel
+sort
+new
+it wolf
+it aardvark
+it squirrel
+it meerkat
+sort
+new
+it bear
+it bear
+it panda
+it gerbil
+it squirrel
+sort
+new
+it panda
+sort
+new
+it meerkat
+it bear
+it panda
+it squirrel
+it panda
+sort
+new
+it bear
+it dolphin
+it dolphin
+it dolphin
+it aardvark
+sort
+new
+it wolf
+sort
+new
+it dolphin
+it wolf
+it wolf
+sort
+new
+it meerkat
+it dolphin
+it vulture
+sort
+new
+it dolphin
+it aardvark
+it aardvark
+it bear
+sort
+new
+it dolphin
+it panda
+it gerbil
+it gerbil
+sort
+new
+sort
+new
+it gerbil
+it jaguar
+sort
+new
+it gerbil
+it wolf
+it meerkat
+it jaguar
+sort
+new
+it panda
+it dolphin
+it aardvark
+it meerkat
+sort
+new
+it wolf
+it vulture
+it panda
+sort
+new
+it dolphin
+it vulture
+it dolphin
+it vulture
+sort
+new
+it aardvark
+it squirrel
+it dolphin
+it wolf
+sort
+new
+sort
+new
+it dolphin
+sort
+new
+it squirrel
+sort
+new
+it bear
+it vulture
+it aardvark
+it meerkat
+sort
+new
+it vulture
+it vulture
+it vulture
+it squirrel
+it bear
+sort
+new
+it aardvark
+it gerbil
+it gerbil
+it jaguar
+sort
+new
+sort
+new
+sort
+new
+it squirrel
+it vulture
+it aardvark
+it bear
+sort
+new
+it meerkat
+it wolf
+it vulture
+sort
+new
+it vulture
+it gerbil
+it jaguar
+it squirrel
+sort
+new
+it vulture
+it squirrel
+it vulture
+it gerbil
+sort
+new
+it vulture
+it jaguar
+it vulture
+it gerbil
+it squirrel
+sort
+new
+it panda
+sort
+new
+sort
+new
+it squirrel
+it meerkat
+it bear
+sort
+new
+it gerbil
+it panda
+it bear
+it gerbil
+it jaguar
+sort
+new
+sort
+new
+it meerkat
+sort
+new
+it jaguar
+sort
+new
+it squirrel
+sort
+new
+it bear
+sort
+new
+it squirrel
+it dolphin
+it gerbil
+sort
+new
+it panda
+sort
+new
+it panda
+it meerkat
+it panda
+it gerbil
+sort
+new
+it meerkat
+it bear
+sort
+new
+it meerkat
+it aardvark
+it meerkat
+it vulture
+it squirrel
+sort
+new
+it aardvark
+it panda
+it meerkat
+sort
+new
+it wolf
+it jaguar
+it vulture
+it bear
+sort
+new
+sort
+new
+it bear
+sort
+new
+sort
+new
+it jaguar
+it aardvark
+sort
+new
+it jaguar
+sort
+new
+it panda
+sort
+new
+it jaguar
+it panda
+it dolphin
+it vulture
+it vulture
+sort
+new
+it squirrel
+it meerkat
+it bear
+it jaguar
+sort
+new
+sort
+new
+it dolphin
+it panda
+it bear
+it jaguar
+it aardvark
+sort
+new
+it bear
+it jaguar
+it bear
+it wolf
+it gerbil
+sort
+new
+sort
+new
+it bear
+it squirrel
+sort
+new
+sort
+new
+it vulture
+it panda
+sort
+new
+it wolf
+it dolphin
+sort
+new
+sort
+new
+it gerbil
+it bear
+it dolphin
+it jaguar
+sort
+new
+sort
+new
+it gerbil
+sort
+new
+it jaguar
+it vulture
+sort
+new
+it jaguar
+sort
+new
+it vulture
+it dolphin
+it jaguar
+sort
+new
+it aardvark
+it jaguar
+sort
+new
+sort
+new
+sort
+new
+sort
+new
+it vulture
+it vulture
+it gerbil
+it vulture
+it squirrel
+sort
+new
+it squirrel
+sort
+new
+sort
+new
+it panda
+it squirrel
+it vulture
+it panda
+it vulture
+sort
+new
+it gerbil
+it gerbil
+sort
+new
+it gerbil
+it dolphin
+sort
+new
+it meerkat
+it aardvark
+it dolphin
+sort
+new
+sort
+new
+sort
+new
+it jaguar
+it panda
+it dolphin
+it aardvark
+it bear
+sort
+new
+it panda
+it vulture
+it jaguar
+it wolf
+it gerbil
+sort
+new
+it jaguar
+it aardvark
+it squirrel
+it dolphin
+it dolphin
+sort
+new
+it squirrel
+it aardvark
+sort
+new
+it meerkat
+it meerkat
+sort
+new
+it meerkat
+it gerbil
+it aardvark
+it jaguar
+sort
+new
+it meerkat
+sort
+new
+it aardvark
+sort
+new
+it panda
+it bear
+sort
+new
+it jaguar
+it vulture
+it gerbil
+sort
+new
+it vulture
+sort
+new
+sort
+new
+sort
+new
+it bear
+it dolphin
+sort
+new
+it wolf
+it aardvark
+it panda
+sort
+new
+sort
+new
+it jaguar
+it gerbil
+sort
+new
+sort
+new
+it vulture
+it dolphin
+it wolf
+it panda
+sort
+new
+it squirrel
+it dolphin
+sort
+new
+it wolf
+it dolphin
+sort
+new
+sort
+new
+it vulture
+it panda
+it vulture
+it dolphin
+it vulture
+sort
+new
+it wolf
+it aardvark
+it wolf
+it gerbil
+sort
+new
+sort
+new
+sort
+new
+sort
+new
+it meerkat
+sort
+new
+sort
+new
+it squirrel
+it vulture
+it aardvark
+sort
+new
+it aardvark
+it vulture
+it gerbil
+it squirrel
+it jaguar
+sort
+new
+sort
+new
+it bear
+it vulture
+it vulture
+sort
+new
+sort
+new
+it vulture
+it bear
+it squirrel
+it jaguar
+it bear
+sort
+new
+it gerbil
+it gerbil
+sort
+new
+it squirrel
+sort
+new
+it panda
+it bear
+it squirrel
+sort
+new
+it jaguar
+it aardvark
+it wolf
+it gerbil
+it bear
+sort
+new
+it dolphin
+it meerkat
+it jaguar
+it jaguar
+sort
+new
+it wolf
+it dolphin
+it aardvark
+it squirrel
+sort
+new
+sort
+new
+it jaguar
+it bear
+it gerbil
+sort
+new
+it squirrel
+it jaguar
+it vulture
+it jaguar
+it squirrel
+sort
+new
+it squirrel
+it bear
+it vulture
+sort
+new
+it jaguar
+sort
+new
+sort
+new
+it aardvark
+it jaguar
+it squirrel
+sort
+new
+sort
+new
+it squirrel
+it jaguar
+it panda
+it gerbil
+sort
+new
+it bear
+sort
+new
+it bear
+it dolphin
+it vulture
+it jaguar
+sort
+new
+it dolphin
+it wolf
+sort
+new
+it vulture
+it jaguar
+it bear
+it meerkat
+it gerbil
+sort
+new
+it squirrel
+it panda
+it aardvark
+sort
+new
+it aardvark
+sort
+new
+it squirrel
+it panda
+it jaguar
+sort
+new
+it dolphin
+it panda
+it meerkat
+it panda
+it meerkat
+sort
+new
+sort
+new
+it aardvark
+it meerkat
+sort
+new
+it panda
+it bear
+sort
+new
+it aardvark
+sort
+new
+it jaguar
+it jaguar
+it meerkat
+it bear
+it panda
+sort
+new
+it wolf
+it bear
+it meerkat
+sort
+new
+it jaguar
+it aardvark
+it jaguar
+sort
+new
+sort
+new
+sort
+new
+it jaguar
+it dolphin
+it gerbil
+it jaguar
+it panda
+sort
+new
+it meerkat
+it gerbil
+it meerkat
+it panda
+sort
+new
+sort
+new
+it panda
+it vulture
+it vulture
+it gerbil
+it bear
+sort
+new
+sort
+new
+it panda
+it squirrel
+it wolf
+it dolphin
+it jaguar
+sort
+new
+it aardvark
+it vulture
+it dolphin
+sort
+new
+it squirrel
+sort
+new
+it meerkat
+it jaguar
+it jaguar
+sort
+new
+it jaguar
+it panda
+sort
+new
+it gerbil
+it jaguar
+it squirrel
+it vulture
+it panda
+sort
+new
+sort
+new
+it dolphin
+sort
+new
+sort
+new
+it vulture
+sort
+new
+it vulture
+it gerbil
+it squirrel
+sort
+new
+it squirrel
+it panda
+sort
+new
+it vulture
+sort
+new
+it gerbil
+sort
+new
+sort
+new
+it meerkat
+sort
+new
+it bear
+it meerkat
+it gerbil
+it meerkat
+sort
+new
+it wolf
+it gerbil
+sort
+new
+sort
+new
+it panda
+it panda
+it panda
+it vulture
+it gerbil
+sort
+new
+it jaguar
+it meerkat
+it aardvark
+sort
+new
+it jaguar
+it wolf
+it meerkat
+sort
+new
+it vulture
+sort
+new
+it gerbil
+it bear
+it jaguar
+it gerbil
+sort
+new
+it panda
+it squirrel
+it panda
+sort
+new
+it aardvark
+it dolphin
+sort
+new
+sort
+new
+it squirrel
+it wolf
+it squirrel
+sort
+new
+sort
+new
+sort
+new
+it vulture
+it squirrel
+it squirrel
+sort
+new
+it bear
+sort
+new
+it dolphin
+sort
+new
+it vulture
+sort
+new
+it bear
+it squirrel
+it bear
+it vulture
+it aardvark
+sort
+new
+sort
+new
+it gerbil
+sort
+new
+it aardvark
+it jaguar
+it dolphin
+it jaguar
+sort
+new
+it panda
+it bear
+it bear
+it bear
+sort
+new
+it vulture
+it wolf
+sort
+new
+it panda
+sort
+new
+it gerbil
+it wolf
+sort
+new
+sort
+new
+sort
+new
+it jaguar
+it squirrel
+it jaguar
+it meerkat
+sort
+new
+it gerbil
+it squirrel
+it vulture
+it gerbil
+it vulture
+sort
+new
+it aardvark
+sort
+new
+it jaguar
+it aardvark
+it aardvark
+sort
+new
+it squirrel
+sort
+new
+it panda
+it bear
+it jaguar
+it gerbil
+it panda
+sort
+new
+it gerbil
+it squirrel
+sort
+new
+sort
+new
+it meerkat
+it panda
+it meerkat
+it panda
+it gerbil
+sort
+new
+sort
+new
+it vulture
+it bear
+sort
+new
+it squirrel
+sort
+new
+it jaguar
+sort
+new
+it gerbil
+sort
+new
+it gerbil
+it jaguar
+it jaguar
+sort
+new
+sort
+new
+it squirrel
+it wolf
+it dolphin
+it gerbil
+sort
+new
+it panda
+it aardvark
+it wolf
+sort
+new
+it panda
+sort
+new
+sort
+merge
+size
+free
+option descend 1
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+new
+ih RAND 3
+sort
+merge
+size
+free
+option descend 0
+quit
@@ -0,0 +1,33 @@
+# Test of dedup hash on unsorted queues, also when its table cannot be allocated
+option fail 0
+option malloc 0
+new
+it gerbil
+it bear
+it gerbil
+ih dolphin
+it bear
+it wolf
+dedup hash
+it wolf
+ih wolf 3
+dedup hash
+it bear
+dedup
+new
+ih RAND 3000
+it gerbil 100
+ih gerbil 100
+dedup hash
+option fail 30
+option seed 1
+option malloc 50
+dedup hash
+dedup hash
+dedup hash
+dedup hash
+option malloc 0
+option seed 0
+free
+free
+quit
@@ -0,0 +1,35 @@
+# Test of positional access: get, da and dm with and without the index
+option fail 0
+option malloc 0
+new
+ih RAND 2000
+get 0
+get 1999
+get 1000 50
+get 2000
+get -1
+da 10 5
+da 0
+da 1993
+da 1993
+dm 3
+option dmindex 1
+dm 3
+reverse
+get 5 3
+da 3 2
+dm 2
+option dmindex 0
+dm 2
+size
+free
+new
+it a
+it b
+it c
+get 1
+da 1
+dm
+dm
+free
+quit
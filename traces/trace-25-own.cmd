@@ -0,0 +1,18 @@
+# Test of insertions handing their strings over to the queue
+option fail 0
+option malloc 0
+option own 1
+new
+ih gerbil
+it jaguar 5
+ih bear 3
+rh bear
+rt jaguar
+sort
+dedup
+reverse
+dm
+option own 0
+it dolphin 3
+free
+quit
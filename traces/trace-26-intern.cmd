@@ -0,0 +1,27 @@
+# Test of interned strings shared by several queues
+option fail 0
+option malloc 0
+option intern 1
+new
+ih gerbil 10
+it jaguar
+it bear 5
+new
+it gerbil
+ih jaguar 3
+ih RAND 100
+sort
+prev
+sort
+merge
+dedup
+rh
+rt
+free
+new
+ih gerbil 5
+rh gerbil
+option intern 0
+it gerbil 2
+free
+quit
@@ -0,0 +1,16 @@
+# Test of queue operations with block filling turned off
+option fail 0
+option malloc 0
+option fill 0
+new
+ih RAND 1000
+it gerbil 20
+sort
+dedup
+reverse
+rh
+rt
+option fill 1
+ih dolphin 5
+free
+quit
@@ -0,0 +1,15 @@
+# Test of the allocation profiler
+option fail 0
+option malloc 0
+option profile 1
+new
+ih RAND 200
+it gerbil 5
+ih bear
+rh bear
+memstat
+sort
+free
+memstat
+option profile 0
+quit
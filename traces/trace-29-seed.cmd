@@ -0,0 +1,21 @@
+# Test of malloc failures decided by a fixed seed
+option fail 50
+option malloc 0
+option seed 42
+new
+option malloc 50
+ih gerbil
+ih gerbil
+it jaguar
+it jaguar
+ih bear
+it dolphin
+option seed 42
+ih gerbil
+ih gerbil
+it jaguar
+it jaguar
+option malloc 0
+option seed 0
+free
+quit
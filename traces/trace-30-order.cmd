@@ -0,0 +1,53 @@
+# Test of sort, merge, dedup, ascend and descend with other orders
+option fail 0
+option malloc 0
+option order 1
+new
+it 10
+it -3
+it 007
+it abc
+it 0
+it -0
+it 99999999999999999999
+it +2
+it 2
+sort
+dedup
+new
+it 5
+it 12
+it 05
+sort
+merge
+descend
+free
+option order 2
+new
+it Banana
+it apple
+it APPLE
+it cherry
+sort
+dedup
+ascend
+option descend 1
+sort
+option descend 0
+free
+option order 3
+new
+it ccc
+it a
+it bb
+it ab
+it b
+sort
+new
+ih RAND 500
+sort
+merge
+descend
+option order 0
+free
+quit
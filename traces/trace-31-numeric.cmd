@@ -0,0 +1,427 @@
+# Test of sorting and merging decimal values on parsed numeric keys
+option fail 0
+option malloc 0
+option order 1
+new
+it 573
+it x
+it 303
+it -914
+it -929
+it 156
+it -804
+it -6102729424006613774836535
+it +0030
+it -6891751229748593622364241
+it -277
+it 2305843009213693952
+it -852
+it 9960136274497863038656004
+it +34
+it -0014
+it 764
+it -108
+it 252
+it -95
+it +
+it -654
+it +
+it 287
+it -963
+it 920
+it 1000000000000000000
+it 940
+it -4525412304998300675551030
+it +14
+it +013
+it +0034
+it -244
+it -258
+it 16
+it -45
+it -82
+it -274
+it 9969086441134218630022292
+it 625764977267789779310289
+it 12a
+it +17
+it +6
+it 374
+it +17
+it -4194431064705970043744648
+it -001
+it 460
+it +16
+it -5660680830730100319139658
+it +
+it 626
+it -419
+it -440
+it x
+it 759
+it -920
+it -996
+it -860
+it -03
+it 1000000000000000000
+it -264
+it -
+it -358
+it 870
+it -15
+it abcdefgh
+it -7612317944335970937073166
+it x
+it +0040
+it -404
+it abc
+it -782
+it -1431076360563538884708644
+it -9305387480265407713761197
+it +0017
+it -035
+it -5944169609950744364858752
+it 2305843009213693952
+it 8665906416528957856648975
+it -2558673364570929713773876
+it -2305843009213693952
+it 809
+it 419
+it 2305843009213693951
+it -192
+it -011
+it -20
+it 617
+it 2305843009213693952
+it -443
+it 247
+it -264
+it x
+it 288
+it 494
+it 12a
+it abcdefgh
+it -5051869447047923771431308
+it +22
+it 928
+it -474
+it 776
+it abc
+it 9
+it -489
+it 12a
+it -211
+it +
+it abc
+it -555
+it -96638125144739683383018
+it -7731077041423261580266828
+it 158
+it 61
+it +0010
+it -
+it +
+it -901
+it 479
+it +30
+it -462
+it abc
+it 153
+it 95
+it -294
+it 990
+it 12a
+it -5683905440698842604518078
+it -0017
+it 425
+it 296
+it -760
+it 95
+it -2305843009213693952
+it x
+it 250
+it x
+it 582
+it 465
+it 1971582214803196209405626
+it -8312930504028380147798712
+it 182
+it 10000000000000000000
+it +0010
+it 12a
+it 707
+it -406
+it -2305843009213693952
+it x
+it +
+it 96
+it -35
+it 6352882336418786817344244
+it 988
+it -545
+it 362
+it -
+it +39
+it 805
+it -2305843009213693952
+it abcdefgh
+it -9638296282506998614058935
+it 2604480972583335328798640
+it -0014
+it -357
+it 2305843009213693952
+it 8385794425079992988168432
+it 293
+it 162
+it abcdefgh
+it 715
+it -74
+it 2305843009213693952
+it abc
+it 2305843009213693951
+it 268
+it -1974257411880569933912815
+it -150
+it abcdefgh
+it 72
+it -703
+it 2305843009213693951
+it 2305843009213693952
+it 957
+it -742
+it -1320939567311749334127703
+it 496
+it -0049
+it -2305843009213693952
+it 140
+it 8868446492294196509317927
+it 993
+it +0034
+it +21
+it -872
+it -818
+it 2305843009213693952
+it -296
+it 2305843009213693952
+it +0023
+it 692
+it x
+it -7062846232741126759789940
+it +002
+it -1141025455907378127258805
+it 12a
+it -2305843009213693952
+it -666
+it -
+it 12a
+it 10000000000000000000
+it -153
+it -0011
+it -112
+it 7133672049793353192118805
+it 14
+it 10000000000000000000
+it -0024
+it -467
+it -931
+it -6474676016610336433985112
+it 2305843009213693952
+it -4819008823190697940715217
+it -30
+it -410
+it 790
+it 490
+it -6293198538858155845425754
+it -0019
+it 12a
+it -437
+it 826
+it 10000000000000000000
+it -800
+it -770
+it -534
+it 381
+it -857
+it -
+it 932
+it -846
+it -972
+it -020
+it 7789002019006125821286150
+it +021
+it -6046483336054002201492944
+it 344
+it -0028
+it -2305843009213693952
+it -357
+it -
+it -01
+it -4787735650100081633088681
+it 5256627005525922951771645
+it 26
+it 165
+it 715
+it +0034
+it -718
+it +009
+it 123
+it -342
+it -739
+it 633
+it -01
+it 255
+it 450
+it -0034
+it -450
+it -643
+it abc
+it -26
+it 2305843009213693952
+it +021
+it 4021597214066373223236921
+it 702
+it -628
+it 471
+it 616
+it -471
+it 612
+it 12a
+it +017
+it 571
+it 441
+it -35
+it -176
+it -225
+it -378
+it -022
+it 2305843009213693952
+it -2305843009213693952
+it 2305843009213693951
+it +03
+it +026
+it -948
+it 338
+it -843
+it -704
+it -701
+it -567
+it 2305843009213693951
+it 723
+it 2305843009213693952
+it -55
+it 512
+it -0048
+it 532
+it 464
+it -16
+it -733
+it 3986873622658194069629002
+it -4
+it 2305843009213693952
+it 2305843009213693951
+it -0025
+it 8895256819557083784825517
+it 1000000000000000000
+it abc
+it -297
+it -99
+it 741
+it 2305843009213693951
+it -2171179056643948699762045
+it -793
+it 3544072196810698594432734
+it -986
+it 2305843009213693952
+it abc
+it -686
+it 111
+it 1000000000000000000
+it -2305843009213693952
+it +0018
+it -142
+it -049
+it -3473402030767395357943005
+it -2305843009213693952
+it -764
+it 432
+it +38
+it x
+it -
+it -5662693878211545437056039
+it 8652823258232523461010853
+it 968
+it +0017
+it -552
+it abcdefgh
+it +047
+it -033
+it x
+it 1000000000000000000
+it -211
+it -47
+it -189
+it 373
+it -39
+it abcdefgh
+it 2305843009213693952
+it x
+it 4599632382067544267505075
+it 2305843009213693952
+it 918
+it -07
+it -133
+it 1000000000000000000
+it -3699201013016690309835212
+it 961
+it -233
+it -739
+it -02
+it -712
+it -1
+it -18
+it -187
+it -2823509809869263450665730
+it 346
+it +30
+it -167
+it -461
+it abc
+it 342
+it +0024
+it 4778383790413503223507141
+it +
+it 6798903030439370809460251
+it -3321089214797870946406114
+it 10000000000000000000
+it +0030
+it -21
+it -780
+it -8356359818223260061685201
+it 1000000000000000000
+it -969
+it -576
+it -664
+it -558
+it 8955926164827958669539507
+sort
+option descend 1
+sort
+option sortalgo 1
+sort
+option descend 0
+sort
+option sortalgo 0
+reverse
+sort
+new
+it 3
+it 0010
+it -7
+sort
+merge
+dedup
+ascend
+descend
+option order 0
+free
+quit